@@ -7,7 +7,26 @@
 #include <QTest>
 #include <QSignalSpy>
 
+#include <cmath>
+#include <vector>
+
+#include "../src/burstsampler.h"
+#include "../src/client.h"
 #include "../src/daemon.h"
+#include "../src/expression.h"
+#include "../src/framebuilder.h"
+#include "../src/frametrace.h"
+#include "../src/metadatastore.h"
+#include "../src/quantilesketch.h"
+#include "../src/sensorindex.h"
+#include "../src/socketserver.h"
+#include "../src/thresholdrule.h"
+#include "../src/valuetable.h"
+#include "../src/ksystemstats_socketprotocol.h"
+
+#include <asyncupdateprovider.h>
+#include <burstsampleprovider.h>
+#include <subscribedsources.h>
 
 #include <systemstats/SensorContainer.h>
 #include <systemstats/SensorObject.h>
@@ -15,10 +34,70 @@
 #include <systemstats/DBusInterface.h>
 
 #include <QDBusConnection>
+#include <QDBusMessage>
 #include <QDBusMetaType>
+#include <QDBusPendingCall>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QPromise>
+#include <QStandardPaths>
+#include <QThread>
+#include <QtEndian>
+
+// Sanitizers replace malloc themselves, overriding it as well breaks their bookkeeping
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define SANITIZER_BUILD
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define SANITIZER_BUILD
+#endif
+#endif
+
+#if defined(__GLIBC__) && !defined(SANITIZER_BUILD)
+#define COUNT_ALLOCATIONS
+#endif
+
+#ifdef COUNT_ALLOCATIONS
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+
+// Counts the heap allocations of the current thread while enabled
+static thread_local bool s_countAllocations = false;
+static thread_local int s_allocations = 0;
+
+extern "C" void *malloc(size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocations;
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    if (s_countAllocations) {
+        ++s_allocations;
+    }
+    return __libc_calloc(count, size);
+}
 
-class TestPlugin : public KSysGuard::SensorPlugin
+extern "C" void *realloc(void *pointer, size_t size)
 {
+    if (s_countAllocations) {
+        ++s_allocations;
+    }
+    return __libc_realloc(pointer, size);
+}
+#endif
+
+class TestPlugin : public KSysGuard::SensorPlugin, public BurstSampleProvider
+{
+    Q_OBJECT
+    Q_INTERFACES(BurstSampleProvider)
 public:
     TestPlugin(QObject *parent)
         : SensorPlugin(parent, {})
@@ -41,13 +120,176 @@ public:
     {
         m_updateCount++;
     }
+    void sampleBurst() override
+    {
+        m_burstSampleCount++;
+        // Like real providers, only sensors somebody is subscribed to get new values
+        if (m_property2->isSubscribed()) {
+            m_property2->setValue(1000 + m_burstSampleCount);
+        }
+    }
     KSysGuard::SensorContainer *m_testContainer;
     KSysGuard::SensorObject *m_testObject;
     KSysGuard::SensorProperty *m_property1;
     KSysGuard::SensorProperty *m_property2;
     int m_updateCount = 0;
+    int m_burstSampleCount = 0;
 };
 
+// Collects the burstSamples signals sent to the test
+class BurstReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    BurstReceiver()
+    {
+        QDBusConnection::sessionBus().connect(QString(),
+                                              KSysGuard::SystemStats::ObjectPath,
+                                              Daemon::ControlInterface,
+                                              QStringLiteral("burstSamples"),
+                                              this,
+                                              SLOT(receive(QDBusMessage)));
+    }
+    struct Delivery {
+        uint burst = 0;
+        BurstSamplesList samples;
+        bool finished = false;
+    };
+    QList<Delivery> m_deliveries;
+
+public Q_SLOTS:
+    void receive(const QDBusMessage &message)
+    {
+        const auto arguments = message.arguments();
+        m_deliveries.append({arguments.value(0).toUInt(), qdbus_cast<BurstSamplesList>(arguments.value(1)), arguments.value(2).toBool()});
+    }
+};
+
+// An asynchronous provider without sensors whose updates do not finish while it hangs
+class HangingPlugin : public KSysGuard::SensorPlugin, public AsyncUpdateProvider
+{
+    Q_OBJECT
+    Q_INTERFACES(AsyncUpdateProvider)
+public:
+    HangingPlugin(QObject *parent)
+        : SensorPlugin(parent, {})
+    {
+    }
+    QString providerName() const override
+    {
+        return "hangingPlugin";
+    }
+    void update() override
+    {
+        m_updateCount++;
+    }
+    QFuture<void> updateAsync() override
+    {
+        m_asyncUpdateCount++;
+        QPromise<void> promise;
+        promise.start();
+        const QFuture<void> future = promise.future();
+        if (m_hang) {
+            m_promises.push_back(std::move(promise));
+        } else {
+            promise.finish();
+        }
+        return future;
+    }
+    void stopHanging()
+    {
+        m_hang = false;
+        // Destroying an unfinished promise cancels and finishes its future
+        m_promises.clear();
+    }
+    int m_updateCount = 0;
+    int m_asyncUpdateCount = 0;
+
+private:
+    bool m_hang = true;
+    std::vector<QPromise<void>> m_promises;
+};
+
+class SlowPlugin : public KSysGuard::SensorPlugin
+{
+public:
+    SlowPlugin(QObject *parent)
+        : SensorPlugin(parent, {})
+    {
+    }
+    QString providerName() const override
+    {
+        return "slowPlugin";
+    }
+    void update() override
+    {
+        m_updateCount++;
+        QThread::msleep(m_updateDuration);
+    }
+    int m_updateCount = 0;
+    int m_updateDuration = 0;
+};
+
+// Stands in for an installed plugin, to be reloaded
+class ReloadablePlugin : public KSysGuard::SensorPlugin
+{
+public:
+    ReloadablePlugin(QObject *parent)
+        : SensorPlugin(parent, {})
+    {
+        auto container = new KSysGuard::SensorContainer("reloadContainer", "Reload Container", this);
+        auto object = new KSysGuard::SensorObject("reloadObject", "Reload Object", container);
+        m_value = new KSysGuard::SensorProperty("value", object);
+    }
+    QString providerName() const override
+    {
+        return "reloadablePlugin";
+    }
+    void update() override
+    {
+        m_updateCount++;
+    }
+    KSysGuard::SensorProperty *m_value;
+    int m_updateCount = 0;
+};
+
+static KPluginMetaData reloadableMetaData()
+{
+    const QJsonObject plugin{{QStringLiteral("Id"), QStringLiteral("reloadable")}, {QStringLiteral("EnabledByDefault"), true}};
+    return KPluginMetaData(QJsonObject{{QStringLiteral("KPlugin"), plugin}}, QString());
+}
+
+// Waits for the next message of the socket protocol, returns its type and payload
+static QByteArray readSocketMessage(QLocalSocket &socket)
+{
+    if (!QTest::qWaitFor([&socket]() { return socket.bytesAvailable() >= 4; })) {
+        return {};
+    }
+    quint32 length = 0;
+    socket.peek(reinterpret_cast<char *>(&length), sizeof(length));
+    length = qFromLittleEndian(length);
+    if (!QTest::qWaitFor([&socket, length]() { return socket.bytesAvailable() >= 4 + length; })) {
+        return {};
+    }
+    socket.skip(sizeof(length));
+    return socket.read(length);
+}
+
+// The daemon reads and writes its configuration, keep it away from the user's
+static void enableTestMode()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+Q_COREAPP_STARTUP_FUNCTION(enableTestMode)
+
+// A connection of its own to call the daemon like other processes do, calls over the local
+// loop of the daemon's connection cannot have delayed replies. Replies need the event loop to
+// run, so they are waited for with QTRY_VERIFY instead of waitForFinished().
+static QDBusConnection secondConnection()
+{
+    return QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("ksystemstatstest"));
+}
+
 class KStatsTest : public Daemon
 {
     Q_OBJECT
@@ -56,6 +298,7 @@ public:
 
 protected:
     void loadProviders() override;
+    KSysGuard::SensorPlugin *instantiatePlugin(const KPluginMetaData &metaData) override;
 private Q_SLOTS:
     void initTestCase();
     void findById();
@@ -63,9 +306,34 @@ private Q_SLOTS:
     void subscription();
     void changes();
     void dbusApi();
+    void coalesceUpdates();
+    void metaDataChanges();
+    void sampleNow();
+    void snapshot();
+    void slowClient();
+    void frameBuilder();
+    void frameAllocations();
+    void thresholdRule();
+    void expression();
+    void quantileSketch();
+    void metaDataStore();
+    void subscribedSources();
+    void sensorIndex();
+    void valueTable();
+    void socketProtocol();
+    void socketBacklog();
+    void frameTrace();
+    void asyncUpdateTimeout();
+    void throttleSlowProvider();
+    void burstSampling();
+    void burstDuration();
+    void clientLimits();
+    void providerReload();
+    void enableProvider();
 
 private:
     TestPlugin *m_testPlugin = nullptr;
+    QPointer<ReloadablePlugin> m_reloadablePlugin;
 };
 
 KStatsTest::KStatsTest()
@@ -86,6 +354,15 @@ void KStatsTest::loadProviders()
     QTest::qWait(0);
 }
 
+KSysGuard::SensorPlugin *KStatsTest::instantiatePlugin(const KPluginMetaData &metaData)
+{
+    if (metaData.pluginId() == QLatin1String("reloadable")) {
+        m_reloadablePlugin = new ReloadablePlugin(this);
+        return m_reloadablePlugin;
+    }
+    return Daemon::instantiatePlugin(metaData);
+}
+
 void KStatsTest::initTestCase()
 {
     QDBusConnection::sessionBus().registerObject(KSysGuard::SystemStats::ObjectPath, this, QDBusConnection::ExportAdaptors);
@@ -127,6 +404,10 @@ void KStatsTest::subscription()
     QCOMPARE(property1Subscribed.count(), 1);
     m_testPlugin->m_property1->unsubscribe();
     QCOMPARE(property1Subscribed.count(), 2);
+
+    m_testPlugin->m_property2->unsubscribe();
+    QCOMPARE(property2Subscribed.count(), 2);
+    QVERIFY(!m_testPlugin->m_testObject->isSubscribed());
 }
 
 void KStatsTest::changes()
@@ -155,8 +436,14 @@ void KStatsTest::dbusApi()
     // query value
     m_testPlugin->m_property1->setValue(100);
 
-    auto pendingValues = iface.sensorData({ "testContainer/testObject/property1" });
-    pendingValues.waitForFinished();
+    // Nobody is subscribed, so the provider is sampled before the reply
+    KSysGuard::SystemStats::DBusInterface remoteIface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        secondConnection(),
+        this);
+    auto pendingValues = remoteIface.sensorData({ "testContainer/testObject/property1" });
+    QTRY_VERIFY(pendingValues.isFinished());
+    QVERIFY(!pendingValues.isError());
     QCOMPARE(pendingValues.value().first().sensorProperty, "testContainer/testObject/property1");
     QCOMPARE(pendingValues.value().first().payload.toInt(), 100);
 
@@ -165,6 +452,11 @@ void KStatsTest::dbusApi()
 
     iface.subscribe({ "testContainer/testObject/property1" });
 
+    // the current value is sent right away, not only with the next change
+    QVERIFY(changesSpy.wait(20));
+    QCOMPARE(changesSpy.first().first().value<KSysGuard::SensorDataList>().first().payload, QVariant(100));
+    changesSpy.clear();
+
     sendFrame();
     // a frame with no changes, does nothing
     QVERIFY(!changesSpy.wait(20));
@@ -184,6 +476,910 @@ void KStatsTest::dbusApi()
     QVERIFY(!changesSpy.wait(20));
 }
 
+void KStatsTest::coalesceUpdates()
+{
+    KSysGuard::SystemStats::DBusInterface iface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        QDBusConnection::sessionBus(),
+        this);
+    QSignalSpy changesSpy(&iface, &KSysGuard::SystemStats::DBusInterface::newSensorData);
+
+    iface.subscribe({ "testContainer/testObject/property1" }).waitForFinished();
+
+    // multiple changes between frames only send the latest value
+    m_testPlugin->m_property1->setValue(200);
+    m_testPlugin->m_property1->setValue(201);
+    sendFrame();
+
+    QVERIFY(changesSpy.wait(20));
+    const auto data = changesSpy.first().first().value<KSysGuard::SensorDataList>();
+    QCOMPARE(data.count(), 1);
+    QCOMPARE(data.first().payload, QVariant(201));
+}
+
+void KStatsTest::metaDataChanges()
+{
+    KSysGuard::SystemStats::DBusInterface iface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        QDBusConnection::sessionBus(),
+        this);
+    QSignalSpy metaDataSpy(&iface, &KSysGuard::SystemStats::DBusInterface::sensorMetaDataChanged);
+
+    iface.subscribe({ "testContainer/testObject/property1" }).waitForFinished();
+
+    // setting the same metadata on every update, like providers do, is not sent
+    for (int i = 0; i < 3; ++i) {
+        m_testPlugin->m_property1->setMax(100);
+        m_testPlugin->m_property1->setValue(300 + i);
+        sendFrame();
+    }
+    QVERIFY(!metaDataSpy.wait(20));
+
+    // neither is a change that is reverted before the next frame
+    m_testPlugin->m_property1->setMax(200);
+    m_testPlugin->m_property1->setMax(100);
+    sendFrame();
+    QVERIFY(!metaDataSpy.wait(20));
+
+    m_testPlugin->m_property1->setMax(200);
+    sendFrame();
+    QVERIFY(metaDataSpy.wait(20));
+    const auto infos = metaDataSpy.first().first().value<KSysGuard::SensorInfoMap>();
+    QCOMPARE(infos.count(), 1);
+    QCOMPARE(infos["testContainer/testObject/property1"].max, 200);
+    metaDataSpy.clear();
+
+    // the change was sent, so setting it again is redundant as well
+    m_testPlugin->m_property1->setMax(200);
+    sendFrame();
+    QVERIFY(!metaDataSpy.wait(20));
+}
+
+void KStatsTest::sampleNow()
+{
+    KSysGuard::SystemStats::DBusInterface iface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        secondConnection(),
+        this);
+
+    // Nobody is subscribed to property 2, so asking for it samples the provider right away
+    QVERIFY(!m_testPlugin->m_property2->isSubscribed());
+    m_testPlugin->m_property2->setValue(7);
+    const int updateCount = m_testPlugin->m_updateCount;
+    const int burstSampleCount = m_testPlugin->m_burstSampleCount;
+    auto pendingValues = iface.sensorData({ "testContainer/testObject/property2" });
+    QTRY_VERIFY(pendingValues.isFinished());
+    QVERIFY(!pendingValues.isError());
+    QCOMPARE(m_testPlugin->m_burstSampleCount, burstSampleCount + 1);
+    QCOMPARE(pendingValues.value().first().payload.toInt(), 1000 + burstSampleCount + 1);
+    // The values subscribers get with the next frame are not affected
+    QCOMPARE(m_testPlugin->m_updateCount, updateCount);
+    QVERIFY(!m_testPlugin->m_property2->isSubscribed());
+}
+
+void KStatsTest::snapshot()
+{
+    const QString sensor = QStringLiteral("testContainer/testObject/property2");
+    QVERIFY(!m_testPlugin->m_property2->isSubscribed());
+    auto message = QDBusMessage::createMethodCall(QDBusConnection::sessionBus().baseService(),
+                                                  KSysGuard::SystemStats::ObjectPath,
+                                                  Daemon::ControlInterface,
+                                                  QStringLiteral("snapshot"));
+    message << QStringList{sensor};
+    QDBusPendingCall pending = secondConnection().asyncCall(message);
+
+    // The sensor was not part of any frame yet, so the reply waits for the next one
+    QTRY_VERIFY(m_testPlugin->m_property2->isSubscribed());
+    QVERIFY(!pending.isFinished());
+    m_testPlugin->m_property2->setValue(9);
+    sendFrame();
+
+    QTRY_VERIFY(pending.isFinished());
+    QVERIFY(!pending.isError());
+    const auto arguments = pending.reply().arguments();
+    QCOMPARE(arguments.size(), 3);
+    const auto values = qdbus_cast<KSysGuard::SensorDataList>(arguments.at(0));
+    QCOMPARE(values.size(), 1);
+    QCOMPARE(values.first().sensorProperty, sensor);
+    QCOMPARE(values.first().payload.toInt(), 9);
+    QVERIFY(arguments.at(1).toULongLong() > 0);
+
+    // Once answered the sensor is not kept up to date for the snapshot anymore
+    QVERIFY(!m_testPlugin->m_property2->isSubscribed());
+}
+
+void KStatsTest::slowClient()
+{
+    // Pings to a name nobody owns fail, like those to a client that does not read its messages
+    const QString service = QStringLiteral("org.kde.ksystemstatstest.slowClient");
+    Client client(this, service);
+    client.subscribeSensors({QStringLiteral("testContainer/testObject/property1")});
+
+    for (int frame = 1; frame <= 10; ++frame) {
+        m_testPlugin->m_property1->setValue(200 + frame);
+        sendFrame();
+        client.sendFrame();
+        QVERIFY(!client.isSlow());
+    }
+
+    // Frames are held back once too many went unacknowledged
+    m_testPlugin->m_property1->setValue(211);
+    sendFrame();
+    client.sendFrame();
+    QVERIFY(client.isSlow());
+    QCOMPARE(client.droppedFrames(), quint64(1));
+    m_testPlugin->m_property1->setValue(212);
+    sendFrame();
+    client.sendFrame();
+    QCOMPARE(client.droppedFrames(), quint64(2));
+
+    KSysGuard::SystemStats::DBusInterface iface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        secondConnection(),
+        this);
+    QSignalSpy changesSpy(&iface, &KSysGuard::SystemStats::DBusInterface::newSensorData);
+    QVERIFY(secondConnection().registerService(service));
+
+    // Once a ping is answered again the client gets only the latest of the held back values
+    for (int frame = 0; client.isSlow() && frame < 50; ++frame) {
+        sendFrame();
+        client.sendFrame();
+        QTest::qWait(20);
+    }
+    QVERIFY(!client.isSlow());
+    sendFrame();
+    client.sendFrame();
+    QVERIFY(changesSpy.wait());
+    QCOMPARE(changesSpy.count(), 1);
+    QCOMPARE(changesSpy.first().first().value<KSysGuard::SensorDataList>().first().payload, QVariant(212));
+
+    QVERIFY(secondConnection().unregisterService(service));
+}
+
+void KStatsTest::frameBuilder()
+{
+    FrameBuilder builder;
+    auto property = m_testPlugin->m_property1;
+
+    const int index = builder.addSensor(property);
+    QCOMPARE(builder.addSensor(property), index);
+    QCOMPARE(builder.path(index), property->path());
+
+    property->setValue(42);
+    property->setValue(43);
+    QVERIFY(builder.changedSensors().isEmpty());
+    QCOMPARE(builder.generation(), quint64(0));
+    builder.buildFrame();
+    QCOMPARE(builder.generation(), quint64(1));
+    QVERIFY(builder.timestamp() > 0);
+    QCOMPARE(builder.changedSensors(), QList<int>{index});
+    QVERIFY(builder.hasValue(index));
+    QCOMPARE(builder.toDouble(index), 43.0);
+    // the original type is restored
+    QCOMPARE(builder.value(index), QVariant(43));
+
+    builder.buildFrame();
+    QVERIFY(builder.changedSensors().isEmpty());
+
+    // sensors are reference counted
+    builder.removeSensor(property);
+    QCOMPARE(builder.indexOf(property), index);
+    builder.removeSensor(property);
+    QCOMPARE(builder.indexOf(property), -1);
+}
+
+void KStatsTest::frameAllocations()
+{
+#ifndef COUNT_ALLOCATIONS
+    QSKIP("Counting allocations needs glibc and does not work with sanitizers");
+#else
+    // Not part of the daemon, so only the frame builder reacts to changes
+    KSysGuard::SensorObject object(QStringLiteral("allocationsObject"), QStringLiteral("Allocations"));
+    auto property = new KSysGuard::SensorProperty(QStringLiteral("value"), &object);
+    FrameBuilder builder;
+    const int index = builder.addSensor(property);
+
+    double sum = 0.0;
+    auto frame = [&](int i) {
+        property->setValue(double(i));
+        builder.buildFrame();
+        auto &values = builder.frameValues();
+        for (int changed : builder.changedSensors()) {
+            values.indices.append(changed);
+        }
+        sum += builder.toDouble(index);
+    };
+
+    // Lets the lists grow to their usual size
+    for (int i = 0; i < 3; ++i) {
+        frame(i);
+    }
+
+    s_allocations = 0;
+    s_countAllocations = true;
+    for (int i = 0; i < 100; ++i) {
+        frame(i);
+    }
+    s_countAllocations = false;
+    QCOMPARE(s_allocations, 0);
+    QCOMPARE(sum, 3.0 + 4950.0);
+
+    builder.removeSensor(property);
+
+    // The part of a frame done for every client, up to where the message is marshalled.
+    // Sending itself allocates the message, and the list of values stays shared with it
+    // until it was written.
+    Client client(this, QStringLiteral("org.kde.ksystemstatstest.allocations"));
+    auto sensor = m_testPlugin->m_property1;
+    client.subscribeSensors({sensor->path()});
+    sum = 0.0;
+    auto clientFrame = [&](int i) {
+        sensor->setValue(double(i));
+        frameBuilder()->buildFrame();
+        client.collectChanges();
+        for (int changed : client.takePendingValues().indices) {
+            sum += frameBuilder()->toDouble(changed);
+        }
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        clientFrame(i);
+    }
+
+    s_allocations = 0;
+    s_countAllocations = true;
+    for (int i = 0; i < 100; ++i) {
+        clientFrame(i);
+    }
+    s_countAllocations = false;
+    QCOMPARE(s_allocations, 0);
+    QCOMPARE(sum, 3.0 + 4950.0);
+#endif
+}
+
+void KStatsTest::thresholdRule()
+{
+    using namespace std::chrono_literals;
+
+    ThresholdRule rule(QStringLiteral("testContainer/*/property2"), ThresholdRule::Comparison::Greater, 90, 5, 1s);
+    QVERIFY(rule.matches("testContainer/testObject/property2"));
+    QVERIFY(!rule.matches("testContainer/testObject/property1"));
+
+    rule.addSensor(m_testPlugin->m_property2);
+    QVERIFY(m_testPlugin->m_property2->isSubscribed());
+
+    const auto start = std::chrono::steady_clock::now();
+    m_testPlugin->m_property2->setValue(50);
+    QVERIFY(rule.evaluate(start).isEmpty());
+
+    // needs to stay above the threshold for the minimum duration
+    m_testPlugin->m_property2->setValue(95);
+    QVERIFY(rule.evaluate(start + 100ms).isEmpty());
+    auto transitions = rule.evaluate(start + 1100ms);
+    QCOMPARE(transitions.count(), 1);
+    QCOMPARE(transitions.first().sensorPath, "testContainer/testObject/property2");
+    QVERIFY(transitions.first().active);
+    QVERIFY(rule.evaluate(start + 2200ms).isEmpty());
+
+    // within hysteresis, no change
+    m_testPlugin->m_property2->setValue(88);
+    QVERIFY(rule.evaluate(start + 2300ms).isEmpty());
+    QVERIFY(rule.evaluate(start + 3400ms).isEmpty());
+
+    m_testPlugin->m_property2->setValue(80);
+    QVERIFY(rule.evaluate(start + 3500ms).isEmpty());
+    transitions = rule.evaluate(start + 4600ms);
+    QCOMPARE(transitions.count(), 1);
+    QVERIFY(!transitions.first().active);
+}
+
+void KStatsTest::expression()
+{
+    auto resolve = [this](const QString &path) {
+        return findSensor(path);
+    };
+
+    m_testPlugin->m_property1->setValue(10);
+    m_testPlugin->m_property2->setValue(30);
+
+    auto expression = Expression::compile("(testContainer/testObject/property1 + testContainer/testObject/property2) / 2", resolve);
+    QVERIFY(expression);
+    QCOMPARE(expression->sources().count(), 2);
+    QCOMPARE(expression->evaluate(), 20.0);
+
+    expression = Expression::compile("max(testContainer/testObject/property1, 2 * -\"testContainer/testObject/property2\", 15) - 1", resolve);
+    QVERIFY(expression);
+    QCOMPARE(expression->evaluate(), 14.0);
+
+    m_testPlugin->m_property1->setValue(25);
+    QCOMPARE(expression->evaluate(), 24.0);
+
+    QString errorMessage;
+    QVERIFY(!Expression::compile("testContainer/testObject/doesNotExist * 2", resolve, &errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+    QVERIFY(!Expression::compile("avg(testContainer/testObject/property1", resolve));
+
+    // Deep nesting is rejected instead of overflowing the stack of the parser
+    QVERIFY(Expression::compile(QString(10, u'(') + QStringLiteral("-1") + QString(10, u')'), resolve));
+    QVERIFY(!Expression::compile(QString(100000, u'(') + QStringLiteral("1") + QString(100000, u')'), resolve));
+    QVERIFY(!Expression::compile(QString(100000, u'-') + QStringLiteral("1"), resolve));
+    QVERIFY(!Expression::compile(QStringLiteral("max(").repeated(100000) + QStringLiteral("1") + QString(100000, u')'), resolve));
+
+    // Clients get an error for expressions that are too long or too deeply nested
+    const QStringList invalidExpressions = {
+        QString(100000, u'(') + QStringLiteral("1") + QString(100000, u')'),
+        QString(1000, u'-') + QStringLiteral("1"),
+    };
+    for (const QString &invalidExpression : invalidExpressions) {
+        auto message = QDBusMessage::createMethodCall(QDBusConnection::sessionBus().baseService(),
+                                                      KSysGuard::SystemStats::ObjectPath,
+                                                      Daemon::ControlInterface,
+                                                      QStringLiteral("addDerivedSensor"));
+        message << QStringLiteral("nested") << QString() << invalidExpression;
+        QDBusPendingCall pending = secondConnection().asyncCall(message);
+        QTRY_VERIFY(pending.isFinished());
+        QCOMPARE(pending.error().type(), QDBusError::InvalidArgs);
+    }
+    QVERIFY(!findSensor(QStringLiteral("derived/nested/value")));
+}
+
+void KStatsTest::quantileSketch()
+{
+    using namespace std::chrono_literals;
+
+    QuantileSketch sketch(10s);
+    QVERIFY(std::isnan(sketch.quantile(0.5)));
+
+    const auto start = QuantileSketch::Clock::now();
+    for (int i = 1; i <= 1000; ++i) {
+        sketch.add(i, start + i * 1ms);
+    }
+    QCOMPARE(sketch.count(), quint64(1000));
+    // estimates are within the relative accuracy of 1%
+    QVERIFY(std::abs(sketch.quantile(0.5) - 500) <= 5);
+    QVERIFY(std::abs(sketch.quantile(0.99) - 990) <= 10);
+    QVERIFY(std::abs(sketch.rank(250) - 0.25) <= 0.01);
+
+    // values older than the window are dropped
+    sketch.add(-5, start + 5s);
+    QVERIFY(std::abs(sketch.quantile(0) + 5) <= 0.05);
+    sketch.advance(start + 12s);
+    QCOMPARE(sketch.count(), quint64(1));
+    sketch.advance(start + 30s);
+    QCOMPARE(sketch.count(), quint64(0));
+}
+
+void KStatsTest::metaDataStore()
+{
+    KSysGuard::SensorObject object(QStringLiteral("metaDataObject"), QStringLiteral("Meta Data"));
+    // built separately like providers do with i18nc, so the strings do not share data
+    auto first = new KSysGuard::SensorProperty(QStringLiteral("first"), QStringLiteral("%1 Usage").arg(1), &object);
+    auto second = new KSysGuard::SensorProperty(QStringLiteral("second"), QStringLiteral("%1 Usage").arg(1), &object);
+    first->setDescription(QStringLiteral("Shared description").toLower());
+    second->setDescription(QStringLiteral("Shared description").toLower());
+    QVERIFY(first->info().name.constData() != second->info().name.constData());
+
+    MetaDataStore store;
+    store.add(&object);
+    QCOMPARE(first->info().name, QStringLiteral("1 Usage"));
+    QCOMPARE(first->info().name.constData(), second->info().name.constData());
+    QCOMPARE(first->info().description.constData(), second->info().description.constData());
+    QCOMPARE(store.size(), qsizetype(2));
+
+    // Strings are kept while any sensor uses them
+    first->setName(QStringLiteral("Other"));
+    store.prune();
+    QCOMPARE(store.size(), qsizetype(2));
+    second->setName(QStringLiteral("Other"));
+    store.prune();
+    QCOMPARE(store.size(), qsizetype(1));
+}
+
+void KStatsTest::subscribedSources()
+{
+    KSysGuard::SensorObject object(QStringLiteral("sourcesObject"), QStringLiteral("Sources"));
+    auto first = new KSysGuard::SensorProperty(QStringLiteral("first"), &object);
+    auto second = new KSysGuard::SensorProperty(QStringLiteral("second"), &object);
+    auto both = new KSysGuard::SensorProperty(QStringLiteral("both"), &object);
+
+    // Properties subscribed before they are added count as well
+    second->subscribe();
+    SubscribedSources<int> sources;
+    sources.addProperty(1, first);
+    sources.addProperty(2, second);
+    sources.addProperty(1, both);
+    sources.addProperty(2, both);
+    QVERIFY(!sources.isNeeded(1));
+    QVERIFY(sources.isNeeded(2));
+    QVERIFY(!sources.isNeeded(3));
+    QVERIFY(sources.isAnyNeeded());
+
+    second->unsubscribe();
+    QVERIFY(!sources.isNeeded(2));
+    QVERIFY(!sources.isAnyNeeded());
+
+    // A property read from several sources needs all of them
+    both->subscribe();
+    QVERIFY(sources.isNeeded(1));
+    QVERIFY(sources.isNeeded(2));
+    first->subscribe();
+    both->unsubscribe();
+    QVERIFY(sources.isNeeded(1));
+    QVERIFY(!sources.isNeeded(2));
+
+    // Only the last unsubscription counts
+    first->subscribe();
+    first->unsubscribe();
+    QVERIFY(sources.isNeeded(1));
+    first->unsubscribe();
+    QVERIFY(!sources.isNeeded(1));
+    QVERIFY(!sources.isAnyNeeded());
+}
+
+void KStatsTest::sensorIndex()
+{
+    KSysGuard::SensorContainer container(QStringLiteral("indexContainer"), QStringLiteral("Index"), nullptr);
+    auto object = new KSysGuard::SensorObject(QStringLiteral("object"), QStringLiteral("Object"), &container);
+    auto temperature = new KSysGuard::SensorProperty(QStringLiteral("temperature"), QStringLiteral("CPU Temperature"), object);
+    temperature->setUnit(KSysGuard::UnitCelsius);
+    temperature->setVariantType(QMetaType::Double);
+    auto rate = new KSysGuard::SensorProperty(QStringLiteral("rate"), QStringLiteral("Download Rate"), object);
+    rate->setUnit(KSysGuard::UnitByteRate);
+    rate->setVariantType(QMetaType::ULongLong);
+
+    SensorIndex index;
+    index.add(object);
+    QCOMPARE(index.size(), qsizetype(2));
+
+    SensorIndex::Filter filter;
+    filter.unit = KSysGuard::UnitCelsius;
+    QCOMPARE(index.find(filter), QList<KSysGuard::SensorProperty *>{temperature});
+
+    filter = {};
+    filter.type = QMetaType::ULongLong;
+    QCOMPARE(index.find(filter), QList<KSysGuard::SensorProperty *>{rate});
+
+    filter = {};
+    filter.name = QStringLiteral("temperature");
+    QCOMPARE(index.find(filter), QList<KSysGuard::SensorProperty *>{temperature});
+
+    filter.container = QStringLiteral("otherContainer");
+    QVERIFY(index.find(filter).isEmpty());
+    filter.container = QStringLiteral("indexContainer");
+    QCOMPARE(index.find(filter).size(), 1);
+
+    // Metadata changes move the sensor to its new keys
+    rate->setUnit(KSysGuard::UnitCelsius);
+    filter = {};
+    filter.unit = KSysGuard::UnitCelsius;
+    QCOMPARE(index.find(filter).size(), 2);
+    filter.unit = KSysGuard::UnitByteRate;
+    QVERIFY(index.find(filter).isEmpty());
+
+    delete temperature;
+    QCOMPARE(index.size(), qsizetype(1));
+    filter.unit = KSysGuard::UnitCelsius;
+    QCOMPARE(index.find(filter), QList<KSysGuard::SensorProperty *>{rate});
+}
+
+void KStatsTest::valueTable()
+{
+    KSysGuard::SensorContainer container(QStringLiteral("tableContainer"), QStringLiteral("Table"), nullptr);
+    auto object = new KSysGuard::SensorObject(QStringLiteral("object"), QStringLiteral("Object"), &container);
+    auto published = new KSysGuard::SensorProperty(QStringLiteral("published"), object);
+    auto other = new KSysGuard::SensorProperty(QStringLiteral("other"), object);
+
+    FrameBuilder builder;
+    ValueTable table(&builder, {QStringLiteral("tableContainer/*/published")}, 4);
+    QVERIFY(table.open(QStringLiteral("/ksystemstats-test-%1").arg(QCoreApplication::applicationPid())));
+    table.addSensor(published);
+    table.addSensor(other);
+
+    const auto header = table.header();
+    QCOMPARE(header->magic, KSYSTEMSTATS_VALUETABLE_MAGIC);
+    QCOMPARE(header->slot_count, 1u);
+    const int slot = ksystemstats_valuetable_find(header, "tableContainer/object/published");
+    QCOMPARE(slot, 0);
+    QCOMPARE(ksystemstats_valuetable_find(header, "tableContainer/object/other"), -1);
+
+    double value = 0.0;
+    int64_t timestamp = 0;
+    QVERIFY(!ksystemstats_valuetable_read(header, slot, &value, &timestamp));
+
+    published->setValue(42);
+    builder.buildFrame();
+    table.write();
+    QVERIFY(ksystemstats_valuetable_read(header, slot, &value, &timestamp));
+    QCOMPARE(value, 42.0);
+    QCOMPARE(qint64(timestamp), builder.timestamp());
+    QCOMPARE(quint64(header->generation), builder.generation());
+
+    // Removed sensors keep their slot but lose their value
+    delete published;
+    QVERIFY(!ksystemstats_valuetable_read(header, slot, &value, &timestamp));
+    QCOMPARE(header->slot_count, 1u);
+}
+
+void KStatsTest::socketProtocol()
+{
+    SocketServer server(this);
+    const QString path = QDir::tempPath() + QStringLiteral("/ksystemstats-test-%1").arg(QCoreApplication::applicationPid());
+    QVERIFY(server.listen(path, false));
+
+    QLocalSocket socket;
+    socket.connectToServer(path);
+    QVERIFY(socket.waitForConnected());
+
+    const QByteArray hello = readSocketMessage(socket);
+    QCOMPARE(hello.size(), 9);
+    QCOMPARE(quint8(hello[0]), quint8(KSYSTEMSTATS_SOCKET_HELLO));
+    QCOMPARE(qFromLittleEndian<quint32>(hello.constData() + 1), KSYSTEMSTATS_SOCKET_MAGIC);
+
+    QByteArray subscribe;
+    subscribe.append(char(KSYSTEMSTATS_SOCKET_SUBSCRIBE));
+    subscribe.append(QByteArray(4, '\0'));
+    qToLittleEndian(quint32(2), subscribe.data() + 1);
+    for (const QByteArray &sensor : {QByteArray("testContainer/testObject/property1"), QByteArray("testContainer/testObject/doesNotExist")}) {
+        QByteArray length(2, '\0');
+        qToLittleEndian(quint16(sensor.size()), length.data());
+        subscribe.append(length + sensor);
+    }
+    QByteArray length(4, '\0');
+    qToLittleEndian(quint32(subscribe.size()), length.data());
+    socket.write(length + subscribe);
+
+    const QByteArray handles = readSocketMessage(socket);
+    QCOMPARE(handles.size(), 13);
+    QCOMPARE(quint8(handles[0]), quint8(KSYSTEMSTATS_SOCKET_HANDLES));
+    QCOMPARE(qFromLittleEndian<quint32>(handles.constData() + 1), 2u);
+    const quint32 handle = qFromLittleEndian<quint32>(handles.constData() + 5);
+    QVERIFY(handle != 0);
+    QCOMPARE(qFromLittleEndian<quint32>(handles.constData() + 9), 0u);
+
+    // The current value follows right away
+    const QByteArray initial = readSocketMessage(socket);
+    QCOMPARE(quint8(initial[0]), quint8(KSYSTEMSTATS_SOCKET_FRAME));
+    QCOMPARE(qFromLittleEndian<quint32>(initial.constData() + 17), 1u);
+    QCOMPARE(qFromLittleEndian<quint32>(initial.constData() + 21), handle);
+    QCOMPARE(quint8(initial[25]), quint8(KSYSTEMSTATS_SOCKET_INT64));
+    QCOMPARE(qFromLittleEndian<qint64>(initial.constData() + 26), frameBuilder()->value(frameBuilder()->indexOf(m_testPlugin->m_property1)).toLongLong());
+
+    m_testPlugin->m_property1->setValue(300);
+    frameBuilder()->buildFrame();
+    server.sendFrame();
+
+    const QByteArray frame = readSocketMessage(socket);
+    QCOMPARE(quint8(frame[0]), quint8(KSYSTEMSTATS_SOCKET_FRAME));
+    QCOMPARE(qFromLittleEndian<quint64>(frame.constData() + 1), frameBuilder()->generation());
+    QCOMPARE(qFromLittleEndian<qint64>(frame.constData() + 9), frameBuilder()->timestamp());
+    QCOMPARE(qFromLittleEndian<quint32>(frame.constData() + 17), 1u);
+    QCOMPARE(qFromLittleEndian<quint32>(frame.constData() + 21), handle);
+    QCOMPARE(quint8(frame[25]), quint8(KSYSTEMSTATS_SOCKET_INT64));
+    QCOMPARE(qFromLittleEndian<qint64>(frame.constData() + 26), qint64(300));
+}
+
+void KStatsTest::socketBacklog()
+{
+    SocketServer server(this);
+    const QString path = QDir::tempPath() + QStringLiteral("/ksystemstats-backlog-test-%1").arg(QCoreApplication::applicationPid());
+    QVERIFY(server.listen(path, false));
+
+    QLocalSocket socket;
+    socket.connectToServer(path);
+    QVERIFY(socket.waitForConnected());
+    const QByteArray hello = readSocketMessage(socket);
+    QCOMPARE(quint8(hello[0]), quint8(KSYSTEMSTATS_SOCKET_HELLO));
+    // Stops reading, so the replies pile up on the side of the daemon
+    socket.setReadBufferSize(1);
+
+    // Sensors that do not exist, each of them still gets a handle of 0 in the reply
+    constexpr quint32 count = 100000;
+    QByteArray subscribe(4 + 1 + 4 + 2 * count, '\0');
+    qToLittleEndian(quint32(subscribe.size() - 4), subscribe.data());
+    subscribe[4] = char(KSYSTEMSTATS_SOCKET_SUBSCRIBE);
+    qToLittleEndian(count, subscribe.data() + 5);
+    for (int i = 0; i < 10; ++i) {
+        socket.write(subscribe);
+    }
+    QTRY_COMPARE(socket.state(), QLocalSocket::UnconnectedState);
+}
+
+void KStatsTest::frameTrace()
+{
+    QVERIFY(!Daemon::frameTrace());
+    setTracingEnabled(true);
+    QVERIFY(Daemon::frameTrace());
+    sendFrame();
+    setTracingEnabled(false);
+    // Nothing is recorded while disabled
+    sendFrame();
+
+    const QJsonDocument document = QJsonDocument::fromJson(trace().toUtf8());
+    QVERIFY(document.isObject());
+    QMultiHash<QString, QJsonObject> events;
+    const QJsonArray traceEvents = document.object().value(QLatin1String("traceEvents")).toArray();
+    for (const auto &event : traceEvents) {
+        events.insert(event[QLatin1String("name")].toString(), event.toObject());
+    }
+
+    QCOMPARE(events.count(QStringLiteral("sendFrame")), 1);
+    QCOMPARE(events.count(QStringLiteral("update testPlugin")), 1);
+    QCOMPARE(events.count(QStringLiteral("buildFrame")), 1);
+
+    // The provider update is nested in the frame
+    const QJsonObject frame = events.value(QStringLiteral("sendFrame"));
+    const QJsonObject update = events.value(QStringLiteral("update testPlugin"));
+    QCOMPARE(frame[QLatin1String("ph")].toString(), QStringLiteral("X"));
+    QVERIFY(update[QLatin1String("ts")].toDouble() >= frame[QLatin1String("ts")].toDouble());
+    QVERIFY(update[QLatin1String("ts")].toDouble() + update[QLatin1String("dur")].toDouble()
+            <= frame[QLatin1String("ts")].toDouble() + frame[QLatin1String("dur")].toDouble());
+}
+
+void KStatsTest::asyncUpdateTimeout()
+{
+    auto plugin = new HangingPlugin(this);
+    registerProvider(plugin);
+
+    sendFrame();
+    QCOMPARE(plugin->m_asyncUpdateCount, 1);
+    // While the asynchronous update is pending only the synchronous part runs
+    sendFrame();
+    QCOMPARE(plugin->m_asyncUpdateCount, 1);
+    QCOMPARE(plugin->m_updateCount, 2);
+
+    // Once it timed out a new update is started with one of the next frames
+    QTRY_COMPARE_WITH_TIMEOUT(plugin->m_asyncUpdateCount, 2, 5000);
+    QVERIFY(plugin->m_updateCount > 2);
+
+    plugin->stopHanging();
+    // The canceled update counts as finished, so there is no need to wait for the timeout
+    QTRY_VERIFY_WITH_TIMEOUT(plugin->m_asyncUpdateCount >= 3, 1500);
+}
+
+void KStatsTest::throttleSlowProvider()
+{
+    // Frames are sent more often, so throttling and recovering does not take long
+    const uint interval = updateInterval();
+    setUpdateInterval(100);
+    auto plugin = new SlowPlugin(this);
+    registerProvider(plugin);
+
+    // Exceeding the default budget of 50 ms a few updates in a row throttles the provider
+    plugin->m_updateDuration = 60;
+    for (int i = 0; i < 3; ++i) {
+        sendFrame();
+    }
+    QCOMPARE(plugin->m_updateCount, 3);
+    sendFrame();
+    sendFrame();
+    QCOMPARE(plugin->m_updateCount, 4);
+
+    // Once it keeps within its budget again, it is updated with every frame again
+    plugin->m_updateDuration = 0;
+    auto updatedWithEveryFrame = [this, plugin]() {
+        const int updateCount = plugin->m_updateCount;
+        sendFrame();
+        sendFrame();
+        return plugin->m_updateCount == updateCount + 2;
+    };
+    QVERIFY(!updatedWithEveryFrame());
+    QTRY_VERIFY_WITH_TIMEOUT(updatedWithEveryFrame(), 5000);
+
+    setUpdateInterval(interval);
+}
+
+void KStatsTest::burstSampling()
+{
+    using namespace std::chrono_literals;
+    BurstReceiver receiver;
+    BurstSampler sampler(QDBusConnection::sessionBus());
+    const QString owner = QDBusConnection::sessionBus().baseService();
+    auto property = m_testPlugin->m_property1;
+    property->setValue(12);
+    const int burstSampleCount = m_testPlugin->m_burstSampleCount;
+    const int updateCount = m_testPlugin->m_updateCount;
+
+    const uint burst = sampler.start(owner, {property}, 10ms, 10s);
+    QVERIFY(property->isSubscribed());
+    QTRY_VERIFY(m_testPlugin->m_burstSampleCount >= burstSampleCount + 3);
+    // Sampling goes through BurstSampleProvider, not the normal update
+    QCOMPARE(m_testPlugin->m_updateCount, updateCount);
+
+    // The samples are buffered till they are delivered together
+    QTest::qWait(50);
+    QVERIFY(receiver.m_deliveries.isEmpty());
+    sampler.deliver();
+    QTRY_COMPARE(receiver.m_deliveries.size(), 1);
+    auto delivery = receiver.m_deliveries.takeFirst();
+    QCOMPARE(delivery.burst, burst);
+    QVERIFY(!delivery.finished);
+    QCOMPARE(delivery.samples.size(), 1);
+    QCOMPARE(delivery.samples.first().sensorId, property->path());
+    QVERIFY(delivery.samples.first().samples.size() >= 3);
+    QCOMPARE(delivery.samples.first().samples.first().value, 12.0);
+
+    // Only the owner can stop a burst, the rest is sent with the next delivery
+    QVERIFY(!sampler.stop(QStringLiteral(":1.12345"), burst));
+    QVERIFY(sampler.stop(owner, burst));
+    const int stoppedSampleCount = m_testPlugin->m_burstSampleCount;
+    QTest::qWait(50);
+    QCOMPARE(m_testPlugin->m_burstSampleCount, stoppedSampleCount);
+    sampler.deliver();
+    QTRY_COMPARE(receiver.m_deliveries.size(), 1);
+    QVERIFY(receiver.m_deliveries.first().finished);
+    QVERIFY(!property->isSubscribed());
+    QVERIFY(!sampler.stop(owner, burst));
+}
+
+void KStatsTest::burstDuration()
+{
+    using namespace std::chrono_literals;
+    BurstReceiver receiver;
+    BurstSampler sampler(QDBusConnection::sessionBus());
+    const QString owner = QDBusConnection::sessionBus().baseService();
+
+    const uint burst = sampler.start(owner, {m_testPlugin->m_property1}, 20ms, 100ms);
+    QTest::qWait(300);
+    // Sampling stops once the duration elapsed, samples are at most interval apart
+    sampler.deliver();
+    QTRY_COMPARE(receiver.m_deliveries.size(), 1);
+    const auto delivery = receiver.m_deliveries.first();
+    QCOMPARE(delivery.burst, burst);
+    QVERIFY(delivery.finished);
+    const auto samples = delivery.samples.first().samples;
+    QVERIFY(samples.size() >= 2);
+    QVERIFY(samples.size() <= 100 / 20 + 1);
+
+    // Finished bursts are removed
+    QVERIFY(!sampler.stop(owner, burst));
+}
+
+void KStatsTest::clientLimits()
+{
+    auto call = [](const QString &method, const QVariantList &arguments) {
+        auto message = QDBusMessage::createMethodCall(QDBusConnection::sessionBus().baseService(),
+                                                      KSysGuard::SystemStats::ObjectPath,
+                                                      Daemon::ControlInterface,
+                                                      method);
+        message.setArguments(arguments);
+        QDBusPendingCall pending = secondConnection().asyncCall(message);
+        QTest::qWaitFor([&pending]() {
+            return pending.isFinished();
+        });
+        return pending;
+    };
+
+    // Every client can only add so many threshold rules
+    const QString pattern = QStringLiteral("testContainer/testObject/doesNotExist");
+    QList<uint> rules;
+    for (int i = 0; i < Client::MaximumThresholdRules; ++i) {
+        auto pending = call(QStringLiteral("addThresholdRule"), {pattern, QStringLiteral(">"), 1.0, 0.0, 0u});
+        QVERIFY(!pending.isError());
+        rules.append(pending.reply().arguments().first().toUInt());
+    }
+    QCOMPARE(call(QStringLiteral("addThresholdRule"), {pattern, QStringLiteral(">"), 1.0, 0.0, 0u}).error().type(), QDBusError::LimitsExceeded);
+    for (uint rule : std::as_const(rules)) {
+        QVERIFY(!call(QStringLiteral("removeThresholdRule"), {rule}).isError());
+    }
+    QVERIFY(!call(QStringLiteral("addThresholdRule"), {pattern, QStringLiteral(">"), 1.0, 0.0, 0u}).isError());
+
+    // and run so many bursts of so many sensors
+    const QString sensor = m_testPlugin->m_property1->path();
+    QStringList sensors(BurstSampler::MaximumSensorsPerBurst + 1, sensor);
+    QCOMPARE(call(QStringLiteral("startBurst"), {sensors, 10u, 1000u}).error().type(), QDBusError::InvalidArgs);
+    QList<uint> bursts;
+    for (int i = 0; i < BurstSampler::MaximumBurstsPerOwner; ++i) {
+        auto pending = call(QStringLiteral("startBurst"), {QStringList{sensor}, 10u, 1000u});
+        QVERIFY(!pending.isError());
+        bursts.append(pending.reply().arguments().first().toUInt());
+    }
+    QCOMPARE(call(QStringLiteral("startBurst"), {QStringList{sensor}, 10u, 1000u}).error().type(), QDBusError::LimitsExceeded);
+
+    // Stopped bursts count till their last samples were delivered
+    for (uint burst : std::as_const(bursts)) {
+        QVERIFY(!call(QStringLiteral("stopBurst"), {burst}).isError());
+    }
+    QCOMPARE(call(QStringLiteral("startBurst"), {QStringList{sensor}, 10u, 1000u}).error().type(), QDBusError::LimitsExceeded);
+    sendFrame();
+    auto pending = call(QStringLiteral("startBurst"), {QStringList{sensor}, 10u, 10u});
+    QVERIFY(!pending.isError());
+    QVERIFY(!call(QStringLiteral("stopBurst"), {pending.reply().arguments().first()}).isError());
+    sendFrame();
+    QVERIFY(!m_testPlugin->m_property1->isSubscribed());
+}
+
+void KStatsTest::providerReload()
+{
+    const QString sensor = QStringLiteral("reloadContainer/reloadObject/value");
+    const QString derived = QStringLiteral("derived/reloaded/value");
+    if (!m_reloadablePlugin) {
+        addPlugin(reloadableMetaData());
+    }
+    QTRY_VERIFY(findSensor(sensor));
+    addDerivedSensor(QStringLiteral("reloaded"), QString(), sensor + QStringLiteral(" * 2"));
+
+    KSysGuard::SystemStats::DBusInterface iface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        QDBusConnection::sessionBus(),
+        this);
+    QSignalSpy changesSpy(&iface, &KSysGuard::SystemStats::DBusInterface::newSensorData);
+    QSignalSpy removedSpy(&iface, &KSysGuard::SystemStats::DBusInterface::sensorRemoved);
+    iface.subscribe({sensor, derived});
+    QTRY_VERIFY(m_reloadablePlugin->m_value->isSubscribed());
+
+    // The sensors are replaced by new ones, clients keep their subscriptions
+    ReloadablePlugin *previous = m_reloadablePlugin;
+    reloadProvider(QStringLiteral("reloadable"));
+    QVERIFY(m_reloadablePlugin);
+    QVERIFY(m_reloadablePlugin != previous);
+    QTRY_VERIFY(m_reloadablePlugin->m_value->isSubscribed());
+
+    changesSpy.clear();
+    m_reloadablePlugin->m_value->setValue(21);
+    sendFrame();
+    QHash<QString, QVariant> values;
+    auto receivedValues = [&]() {
+        for (const auto &arguments : std::as_const(changesSpy)) {
+            const auto data = arguments.first().value<KSysGuard::SensorDataList>();
+            for (const auto &entry : data) {
+                values.insert(entry.sensorProperty, entry.payload);
+            }
+        }
+        changesSpy.clear();
+        return values.contains(sensor) && values.contains(derived);
+    };
+    QTRY_VERIFY(receivedValues());
+    QCOMPARE(values.value(sensor).toInt(), 21);
+    // Derived sensors use the new source
+    QCOMPARE(values.value(derived).toDouble(), 42.0);
+    QVERIFY(removedSpy.isEmpty());
+
+    iface.unsubscribe({sensor, derived});
+    removeDerivedSensor(QStringLiteral("reloaded"));
+}
+
+void KStatsTest::enableProvider()
+{
+    const QString pluginId = QStringLiteral("reloadable");
+    const QString sensor = QStringLiteral("reloadContainer/reloadObject/value");
+    if (!m_reloadablePlugin) {
+        addPlugin(reloadableMetaData());
+    }
+    QTRY_VERIFY(findSensor(sensor));
+
+    KSysGuard::SystemStats::DBusInterface iface(QDBusConnection::sessionBus().baseService(),
+        KSysGuard::SystemStats::ObjectPath,
+        QDBusConnection::sessionBus(),
+        this);
+    QSignalSpy addedSpy(&iface, &KSysGuard::SystemStats::DBusInterface::sensorAdded);
+    QSignalSpy removedSpy(&iface, &KSysGuard::SystemStats::DBusInterface::sensorRemoved);
+
+    setProviderUpdateInterval(pluginId, 2000);
+    setProviderEnabled(pluginId, false);
+    QVERIFY(!m_reloadablePlugin);
+    QVERIFY(!findSensor(sensor));
+    QTRY_VERIFY(removedSpy.contains(QVariantList{sensor}));
+    auto entry = providers().value(pluginId).toMap();
+    QCOMPARE(entry.value(QStringLiteral("enabled")).toBool(), false);
+    QCOMPARE(entry.value(QStringLiteral("loaded")).toBool(), false);
+
+    setProviderEnabled(pluginId, true);
+    QVERIFY(m_reloadablePlugin);
+    QTRY_VERIFY(findSensor(sensor));
+    QTRY_VERIFY(addedSpy.contains(QVariantList{sensor}));
+    entry = providers().value(pluginId).toMap();
+    QCOMPARE(entry.value(QStringLiteral("enabled")).toBool(), true);
+    QCOMPARE(entry.value(QStringLiteral("loaded")).toBool(), true);
+
+    // The interval set before disabling it still applies
+    QCOMPARE(entry.value(QStringLiteral("updateInterval")).toUInt(), 2000u);
+    sendFrame();
+    sendFrame();
+    QCOMPARE(m_reloadablePlugin->m_updateCount, 1);
+
+    setProviderUpdateInterval(pluginId, 0);
+}
+
 QTEST_GUILESS_MAIN(KStatsTest)
 
 #include "main.moc"
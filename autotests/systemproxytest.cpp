@@ -0,0 +1,200 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include <QTest>
+#include <QSignalSpy>
+
+#include <memory>
+
+#include "../src/daemon.h"
+#include "../src/systemproxy.h"
+
+#include <systemstats/DBusInterface.h>
+#include <systemstats/SensorContainer.h>
+#include <systemstats/SensorObject.h>
+#include <systemstats/SensorPlugin.h>
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMetaType>
+#include <QProcess>
+#include <QStandardPaths>
+
+// The system instance and the proxy each have a connection of their own to the bus standing
+// in for the system bus, like they would as separate processes
+static const QString SystemDaemonConnection = QStringLiteral("systemproxytest-daemon");
+static const QString SystemProxyConnection = QStringLiteral("systemproxytest-proxy");
+// The proxy serves the session on a connection that is not used by the test's clients, calls
+// over the local loop cannot have delayed replies
+static const QString SessionProxyConnection = QStringLiteral("systemproxytest-session");
+static const QString SecondClientConnection = QStringLiteral("systemproxytest-client");
+
+static const QString Sensor = QStringLiteral("testContainer/testObject/property1");
+
+class TestPlugin : public KSysGuard::SensorPlugin
+{
+public:
+    TestPlugin(QObject *parent)
+        : SensorPlugin(parent, {})
+    {
+        auto container = new KSysGuard::SensorContainer("testContainer", "Test Container", this);
+        auto object = new KSysGuard::SensorObject("testObject", "Test Object", container);
+        m_property1 = new KSysGuard::SensorProperty("property1", object);
+    }
+    QString providerName() const override
+    {
+        return "testPlugin";
+    }
+    KSysGuard::SensorProperty *m_property1;
+};
+
+class SystemDaemon : public Daemon
+{
+public:
+    using Daemon::Daemon;
+    using Daemon::sendFrame;
+
+    TestPlugin *m_testPlugin = nullptr;
+
+protected:
+    void loadProviders() override
+    {
+        m_testPlugin = new TestPlugin(this);
+        registerProvider(m_testPlugin);
+        QTest::qWait(0);
+    }
+};
+
+class SystemProxyTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    void forwardValues();
+    void laterSubscriber();
+    void systemInstanceStopped();
+
+private:
+    QProcess m_systemBus;
+    std::unique_ptr<SystemDaemon> m_daemon;
+    std::unique_ptr<SystemProxy> m_proxy;
+};
+
+void SystemProxyTest::initTestCase()
+{
+    qDBusRegisterMetaType<KSysGuard::SensorData>();
+    qDBusRegisterMetaType<KSysGuard::SensorDataList>();
+
+    const QString dbusDaemon = QStandardPaths::findExecutable(QStringLiteral("dbus-daemon"));
+    if (dbusDaemon.isEmpty()) {
+        QSKIP("Needs dbus-daemon to start a bus that stands in for the system bus");
+    }
+    m_systemBus.start(dbusDaemon, {QStringLiteral("--session"), QStringLiteral("--nofork"), QStringLiteral("--print-address")});
+    QVERIFY(m_systemBus.waitForReadyRead());
+    const QString address = QString::fromUtf8(m_systemBus.readLine()).trimmed();
+    QVERIFY(QDBusConnection::connectToBus(address, SystemDaemonConnection).isConnected());
+    QVERIFY(QDBusConnection::connectToBus(address, SystemProxyConnection).isConnected());
+    QVERIFY(QDBusConnection::connectToBus(QDBusConnection::SessionBus, SessionProxyConnection).isConnected());
+    QVERIFY(QDBusConnection::connectToBus(QDBusConnection::SessionBus, SecondClientConnection).isConnected());
+}
+
+void SystemProxyTest::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromBus(SystemDaemonConnection);
+    QDBusConnection::disconnectFromBus(SystemProxyConnection);
+    m_systemBus.terminate();
+    m_systemBus.waitForFinished();
+}
+
+void SystemProxyTest::init()
+{
+    m_daemon = std::make_unique<SystemDaemon>(QDBusConnection(SystemDaemonConnection));
+    m_daemon->setQuitOnLastClientDisconnect(false);
+    QVERIFY(m_daemon->init(Daemon::ReplaceIfRunning::DoNotReplace));
+
+    m_proxy = std::make_unique<SystemProxy>(QDBusConnection(SystemProxyConnection), QDBusConnection(SessionProxyConnection));
+    m_proxy->setQuitOnLastClientDisconnect(false);
+    QVERIFY(m_proxy->init(Daemon::ReplaceIfRunning::DoNotReplace));
+}
+
+void SystemProxyTest::cleanup()
+{
+    m_proxy.reset();
+    QDBusConnection(SessionProxyConnection).unregisterService(KSysGuard::SystemStats::ServiceName);
+    m_daemon.reset();
+    QDBusConnection(SystemDaemonConnection).unregisterService(KSysGuard::SystemStats::ServiceName);
+}
+
+void SystemProxyTest::forwardValues()
+{
+    m_daemon->m_testPlugin->m_property1->setValue(5);
+    m_daemon->sendFrame();
+
+    KSysGuard::SystemStats::DBusInterface iface(KSysGuard::SystemStats::ServiceName,
+                                                KSysGuard::SystemStats::ObjectPath,
+                                                QDBusConnection::sessionBus());
+    QSignalSpy changesSpy(&iface, &KSysGuard::SystemStats::DBusInterface::newSensorData);
+    iface.subscribe({Sensor});
+
+    // The current value is passed on from the system instance
+    QVERIFY(changesSpy.wait());
+    QCOMPARE(changesSpy.first().first().value<KSysGuard::SensorDataList>().first().payload, QVariant(5));
+    changesSpy.clear();
+
+    m_daemon->m_testPlugin->m_property1->setValue(6);
+    m_daemon->sendFrame();
+    QVERIFY(changesSpy.wait());
+    const auto data = changesSpy.first().first().value<KSysGuard::SensorDataList>();
+    QCOMPARE(data.first().sensorProperty, Sensor);
+    QCOMPARE(data.first().payload, QVariant(6));
+
+    // Method calls are forwarded
+    auto pendingSensors = iface.allSensors();
+    QTRY_VERIFY(pendingSensors.isFinished());
+    QVERIFY(pendingSensors.value().contains(Sensor));
+}
+
+void SystemProxyTest::laterSubscriber()
+{
+    m_daemon->m_testPlugin->m_property1->setValue(7);
+    m_daemon->sendFrame();
+
+    KSysGuard::SystemStats::DBusInterface first(KSysGuard::SystemStats::ServiceName,
+                                                KSysGuard::SystemStats::ObjectPath,
+                                                QDBusConnection::sessionBus());
+    QSignalSpy firstSpy(&first, &KSysGuard::SystemStats::DBusInterface::newSensorData);
+    first.subscribe({Sensor});
+    QVERIFY(firstSpy.wait());
+
+    // The system instance is already subscribed, so it does not send the value again
+    KSysGuard::SystemStats::DBusInterface second(KSysGuard::SystemStats::ServiceName,
+                                                 KSysGuard::SystemStats::ObjectPath,
+                                                 QDBusConnection(SecondClientConnection));
+    QSignalSpy secondSpy(&second, &KSysGuard::SystemStats::DBusInterface::newSensorData);
+    second.subscribe({Sensor});
+    QVERIFY(secondSpy.wait());
+    QCOMPARE(secondSpy.first().first().value<KSysGuard::SensorDataList>().first().payload, QVariant(7));
+    second.unsubscribe({Sensor});
+}
+
+void SystemProxyTest::systemInstanceStopped()
+{
+    auto session = QDBusConnection::sessionBus().interface();
+    QVERIFY(session->isServiceRegistered(KSysGuard::SystemStats::ServiceName));
+
+    // The proxy makes way for an instance of the session's own
+    QDBusConnection(SystemDaemonConnection).unregisterService(KSysGuard::SystemStats::ServiceName);
+    QTRY_VERIFY(!session->isServiceRegistered(KSysGuard::SystemStats::ServiceName));
+}
+
+QTEST_GUILESS_MAIN(SystemProxyTest)
+
+#include "systemproxytest.moc"
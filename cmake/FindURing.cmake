@@ -0,0 +1,33 @@
+# SPDX-License-Identifier: BSD-2-Clause
+# SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+# - Try to find liburing
+# Once done this will define
+#
+#  URing_FOUND - system has liburing
+#  URing_INCLUDE_DIRS - the liburing include directory
+#  URing_LIBRARIES - the libraries needed to use liburing
+#  URing::URing - imported target for liburing
+
+find_package(PkgConfig QUIET)
+pkg_check_modules(PC_URING QUIET liburing)
+
+find_path(URing_INCLUDE_DIR liburing.h HINTS ${PC_URING_INCLUDE_DIRS})
+find_library(URing_LIBRARY NAMES uring HINTS ${PC_URING_LIBRARY_DIRS})
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(URing DEFAULT_MSG URing_LIBRARY URing_INCLUDE_DIR)
+
+if(URing_FOUND)
+    set(URing_INCLUDE_DIRS ${URing_INCLUDE_DIR})
+    set(URing_LIBRARIES ${URing_LIBRARY})
+    if(NOT TARGET URing::URing)
+        add_library(URing::URing UNKNOWN IMPORTED)
+        set_target_properties(URing::URing PROPERTIES
+            IMPORTED_LOCATION "${URing_LIBRARY}"
+            INTERFACE_INCLUDE_DIRECTORIES "${URing_INCLUDE_DIR}"
+        )
+    endif()
+endif()
+
+mark_as_advanced(URing_INCLUDE_DIR URing_LIBRARY)
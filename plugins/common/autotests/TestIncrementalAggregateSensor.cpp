@@ -0,0 +1,161 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include <QTest>
+
+#include <systemstats/SensorContainer.h>
+#include <systemstats/SensorObject.h>
+#include <systemstats/SensorPlugin.h>
+
+#include "incrementalaggregatesensor.h"
+
+class TestPlugin : public KSysGuard::SensorPlugin
+{
+public:
+    TestPlugin()
+        : SensorPlugin(nullptr, {})
+    {
+    }
+    QString providerName() const override
+    {
+        return QStringLiteral("test");
+    }
+};
+
+class IncrementalAggregateSensorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testFunctions();
+    void testObjectChanges();
+    void testFilter();
+    void testSubscription();
+
+private:
+    KSysGuard::SensorProperty *addSource(const QString &id, double value);
+
+    TestPlugin *m_plugin = nullptr;
+    KSysGuard::SensorContainer *m_container = nullptr;
+    KSysGuard::SensorObject *m_all = nullptr;
+};
+
+void IncrementalAggregateSensorTest::init()
+{
+    m_plugin = new TestPlugin;
+    m_container = new KSysGuard::SensorContainer(QStringLiteral("test"), QStringLiteral("Test"), m_plugin);
+    m_all = new KSysGuard::SensorObject(QStringLiteral("all"), QStringLiteral("All"), m_container);
+}
+
+void IncrementalAggregateSensorTest::cleanup()
+{
+    delete m_plugin;
+}
+
+KSysGuard::SensorProperty *IncrementalAggregateSensorTest::addSource(const QString &id, double value)
+{
+    auto object = new KSysGuard::SensorObject(id, id, m_container);
+    return new KSysGuard::SensorProperty(QStringLiteral("value"), QStringLiteral("Value"), value, object);
+}
+
+void IncrementalAggregateSensorTest::testFunctions()
+{
+    using Function = IncrementalAggregateSensor::Function;
+
+    auto first = addSource(QStringLiteral("first"), 4);
+    auto second = addSource(QStringLiteral("second"), 1);
+    auto third = addSource(QStringLiteral("third"), 7);
+
+    const QRegularExpression notAll(QStringLiteral("^(?!all).*$"));
+    auto sum = new IncrementalAggregateSensor(m_all, QStringLiteral("sum"), QString(), Function::Sum);
+    sum->setMatchSensors(notAll, QStringLiteral("value"));
+    auto average = new IncrementalAggregateSensor(m_all, QStringLiteral("average"), QString(), Function::Average);
+    average->setMatchSensors(notAll, QStringLiteral("value"));
+    auto minimum = new IncrementalAggregateSensor(m_all, QStringLiteral("minimum"), QString(), Function::Minimum);
+    minimum->setMatchSensors(notAll, QStringLiteral("value"));
+    auto maximum = new IncrementalAggregateSensor(m_all, QStringLiteral("maximum"), QString(), Function::Maximum);
+    maximum->setMatchSensors(notAll, QStringLiteral("value"));
+
+    QCOMPARE(sum->matchCount(), 3);
+    QCOMPARE(sum->value().toDouble(), 12.0);
+    QCOMPARE(average->value().toDouble(), 4.0);
+    QCOMPARE(minimum->value().toDouble(), 1.0);
+    QCOMPARE(maximum->value().toDouble(), 7.0);
+
+    // The current minimum and maximum move to other sensors
+    second->setValue(9);
+    QCOMPARE(sum->value().toDouble(), 20.0);
+    QCOMPARE(minimum->value().toDouble(), 4.0);
+    QCOMPARE(maximum->value().toDouble(), 9.0);
+
+    third->setValue(-2);
+    first->setValue(5);
+    QCOMPARE(sum->value().toDouble(), 12.0);
+    QCOMPARE(average->value().toDouble(), 4.0);
+    QCOMPARE(minimum->value().toDouble(), -2.0);
+    QCOMPARE(maximum->value().toDouble(), 9.0);
+}
+
+void IncrementalAggregateSensorTest::testObjectChanges()
+{
+    auto first = addSource(QStringLiteral("first"), 3);
+    auto maximum = new IncrementalAggregateSensor(m_all, QStringLiteral("maximum"), QString(), IncrementalAggregateSensor::Function::Maximum, 0);
+    maximum->setMatchSensors(QRegularExpression(QStringLiteral("^(?!all).*$")), QStringLiteral("value"));
+    QCOMPARE(maximum->value().toDouble(), 3.0);
+
+    // Sensors of new objects are matched once the object is complete
+    auto second = addSource(QStringLiteral("second"), 8);
+    QTRY_COMPARE(maximum->matchCount(), 2);
+    QCOMPARE(maximum->value().toDouble(), 8.0);
+
+    delete second->parentObject();
+    QCOMPARE(maximum->matchCount(), 1);
+    QCOMPARE(maximum->value().toDouble(), 3.0);
+
+    delete first->parentObject();
+    QCOMPARE(maximum->matchCount(), 0);
+    QCOMPARE(maximum->value().toDouble(), 0.0);
+}
+
+void IncrementalAggregateSensorTest::testFilter()
+{
+    addSource(QStringLiteral("first"), 3);
+    addSource(QStringLiteral("second"), 5);
+
+    auto sum = new IncrementalAggregateSensor(m_all, QStringLiteral("sum"), QString());
+    sum->setMatchSensors(QRegularExpression(QStringLiteral("^.*$")), QStringLiteral("value"));
+    sum->setFilterFunction([](const KSysGuard::SensorProperty *sensor) {
+        return sensor->parentObject()->id() != QLatin1String("second");
+    });
+    QCOMPARE(sum->matchCount(), 1);
+    QCOMPARE(sum->value().toDouble(), 3.0);
+}
+
+void IncrementalAggregateSensorTest::testSubscription()
+{
+    auto first = addSource(QStringLiteral("first"), 1);
+    auto sum = new IncrementalAggregateSensor(m_all, QStringLiteral("sum"), QString());
+    sum->setMatchSensors(QRegularExpression(QStringLiteral("^(?!all).*$")), QStringLiteral("value"));
+
+    sum->subscribe();
+    QVERIFY(first->isSubscribed());
+
+    // Sensors matched while subscribed are subscribed as well
+    auto second = addSource(QStringLiteral("second"), 2);
+    QTRY_VERIFY(second->isSubscribed());
+    QCOMPARE(sum->value().toDouble(), 3.0);
+
+    sum->unsubscribe();
+    QVERIFY(!first->isSubscribed());
+    QVERIFY(!second->isSubscribed());
+}
+
+QTEST_GUILESS_MAIN(IncrementalAggregateSensorTest)
+
+#include "TestIncrementalAggregateSensor.moc"
@@ -0,0 +1,102 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include <QTemporaryFile>
+#include <QTest>
+
+#include "readbatch.h"
+#include "sourcefile.h"
+
+class SourceFileTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRead();
+    void testTakeLine();
+    void testTakeField();
+    void testReadBatch();
+};
+
+void SourceFileTest::testRead()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("first");
+    file.flush();
+
+    SourceFile source(file.fileName());
+    QVERIFY(source.isOpen());
+    QCOMPARE(source.read().toByteArray(), QByteArray("first"));
+
+    // Rereads from the start without opening the file again
+    file.resize(0);
+    file.seek(0);
+    file.write("second");
+    file.flush();
+    QCOMPARE(source.read().toByteArray(), QByteArray("second"));
+
+    // Larger than the initial buffer
+    const QByteArray large(10000, 'x');
+    file.seek(0);
+    file.write(large);
+    file.flush();
+    QCOMPARE(source.read().toByteArray(), large);
+
+    SourceFile missing(QStringLiteral("/nonexistent"));
+    QVERIFY(!missing.isOpen());
+    QVERIFY(missing.read().isEmpty());
+}
+
+void SourceFileTest::testTakeLine()
+{
+    QByteArrayView text = "one\ntwo\n\nthree";
+    QCOMPARE(SourceText::takeLine(text).toByteArray(), QByteArray("one"));
+    QCOMPARE(SourceText::takeLine(text).toByteArray(), QByteArray("two"));
+    QCOMPARE(SourceText::takeLine(text).toByteArray(), QByteArray(""));
+    QCOMPARE(SourceText::takeLine(text).toByteArray(), QByteArray("three"));
+    QVERIFY(text.isEmpty());
+}
+
+void SourceFileTest::testTakeField()
+{
+    QByteArrayView line = "cpu0  12 \t34 5";
+    QCOMPARE(SourceText::takeField(line).toByteArray(), QByteArray("cpu0"));
+    QCOMPARE(SourceText::takeField(line).toByteArray(), QByteArray("12"));
+    QCOMPARE(SourceText::takeField(line).toByteArray(), QByteArray("34"));
+    QCOMPARE(SourceText::takeField(line).toByteArray(), QByteArray("5"));
+    QVERIFY(SourceText::takeField(line).isEmpty());
+}
+
+void SourceFileTest::testReadBatch()
+{
+    QTemporaryFile first;
+    QVERIFY(first.open());
+    first.write("1\n");
+    first.flush();
+    QTemporaryFile second;
+    QVERIFY(second.open());
+    second.write("2\n");
+    second.flush();
+
+    ReadBatch batch;
+    const int firstIndex = batch.addFile(first.fileName());
+    const int secondIndex = batch.addFile(second.fileName());
+    QCOMPARE(batch.addFile(QStringLiteral("/nonexistent")), -1);
+
+    batch.submit();
+    QCOMPARE(batch.data(firstIndex).toByteArray(), QByteArray("1\n"));
+    QCOMPARE(batch.data(secondIndex).toByteArray(), QByteArray("2\n"));
+
+    batch.setActive(secondIndex, false);
+    batch.submit();
+    QCOMPARE(batch.data(firstIndex).toByteArray(), QByteArray("1\n"));
+    QVERIFY(batch.data(secondIndex).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(SourceFileTest)
+
+#include "TestSourceFile.moc"
@@ -0,0 +1,286 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "incrementalaggregatesensor.h"
+
+#include <QTimer>
+
+#include <systemstats/SensorContainer.h>
+#include <systemstats/SensorObject.h>
+
+// Adding differences to a sum of doubles slowly loses precision, so it is computed
+// from scratch again after this many updates
+constexpr int SumResyncInterval = 4096;
+
+IncrementalAggregateSensor::IncrementalAggregateSensor(KSysGuard::SensorObject *parent,
+                                                       const QString &id,
+                                                       const QString &name,
+                                                       Function function,
+                                                       const QVariant &initialValue)
+    : KSysGuard::SensorProperty(id, name, initialValue, parent)
+    , m_function(function)
+    , m_initialValue(initialValue)
+    , m_container(qobject_cast<KSysGuard::SensorContainer *>(parent->parent()))
+{
+    if (m_container) {
+        connect(m_container, &KSysGuard::SensorContainer::objectAdded, this, [this](KSysGuard::SensorObject *object) {
+            // Objects are added from the SensorObject constructor, before subclasses created their sensors
+            QTimer::singleShot(0, this, [this, object = QPointer(object)]() {
+                if (object) {
+                    addObject(object);
+                    publish();
+                }
+            });
+        });
+        connect(m_container, &KSysGuard::SensorContainer::objectRemoved, this, [this](KSysGuard::SensorObject *object) {
+            removeObject(object);
+            publish();
+        });
+    }
+
+    connect(this, &KSysGuard::SensorProperty::subscribedChanged, this, [this](bool subscribed) {
+        for (const auto &[sensor, source] : m_sources) {
+            if (subscribed) {
+                sensor->subscribe();
+            } else {
+                sensor->unsubscribe();
+            }
+        }
+        if (subscribed) {
+            recompute();
+            publish();
+        }
+    });
+}
+
+IncrementalAggregateSensor::~IncrementalAggregateSensor()
+{
+    for (const auto &[sensor, source] : m_sources) {
+        disconnect(source->valueChanged);
+        disconnect(source->destroyed);
+        if (isSubscribed()) {
+            sensor->unsubscribe();
+        }
+    }
+}
+
+void IncrementalAggregateSensor::setMatchSensors(const QRegularExpression &objectIds, const QString &propertyId)
+{
+    m_objectIds = objectIds;
+    m_propertyId = propertyId;
+    updateMatches();
+}
+
+void IncrementalAggregateSensor::setFilterFunction(const FilterFunction &function)
+{
+    m_filterFunction = function;
+    updateMatches();
+}
+
+int IncrementalAggregateSensor::matchCount() const
+{
+    return int(m_sources.size());
+}
+
+void IncrementalAggregateSensor::updateMatches()
+{
+    while (!m_sources.empty()) {
+        removeSensor(m_sources.begin()->first);
+    }
+
+    if (m_container) {
+        const auto objects = m_container->objects();
+        for (auto object : objects) {
+            addObject(object);
+        }
+    }
+    publish();
+}
+
+void IncrementalAggregateSensor::addObject(KSysGuard::SensorObject *object)
+{
+    if (object == parentObject() || m_propertyId.isEmpty() || !object->id().contains(m_objectIds)) {
+        return;
+    }
+    if (auto sensor = object->sensor(m_propertyId)) {
+        addSensor(sensor);
+    }
+}
+
+void IncrementalAggregateSensor::removeObject(KSysGuard::SensorObject *object)
+{
+    for (auto it = m_sources.begin(); it != m_sources.end(); ++it) {
+        if (it->first->parentObject() == object) {
+            removeSensor(it->first);
+            return;
+        }
+    }
+}
+
+void IncrementalAggregateSensor::addSensor(KSysGuard::SensorProperty *sensor)
+{
+    if (m_sources.contains(sensor) || (m_filterFunction && !m_filterFunction(sensor))) {
+        return;
+    }
+
+    auto source = std::make_unique<Source>();
+    source->value = sensor->value().toDouble();
+    source->valueChanged = connect(sensor, &KSysGuard::SensorProperty::valueChanged, this, [this, sensor, source = source.get()]() {
+        const double value = sensor->value().toDouble();
+        if (value != source->value) {
+            m_sum += value - source->value;
+            ++m_sumUpdates;
+            source->value = value;
+            updateSource(source);
+            publish();
+        }
+    });
+    source->destroyed = connect(sensor, &QObject::destroyed, this, [this, sensor]() {
+        removeSensor(sensor, true);
+        publish();
+    });
+
+    if (isSubscribed()) {
+        sensor->subscribe();
+    }
+
+    m_sum += source->value;
+    if (usesHeap()) {
+        m_heap.push_back(source.get());
+        place(m_heap.size() - 1, source.get());
+        siftUp(m_heap.size() - 1);
+    }
+    m_sources.emplace(sensor, std::move(source));
+}
+
+void IncrementalAggregateSensor::removeSensor(KSysGuard::SensorProperty *sensor, bool destroyed)
+{
+    auto it = m_sources.find(sensor);
+    if (it == m_sources.end()) {
+        return;
+    }
+    Source *source = it->second.get();
+
+    disconnect(source->valueChanged);
+    disconnect(source->destroyed);
+    // A sensor that is being destroyed cannot be unsubscribed from anymore
+    if (!destroyed && isSubscribed()) {
+        sensor->unsubscribe();
+    }
+
+    m_sum -= source->value;
+    if (usesHeap()) {
+        const std::size_t index = source->heapIndex;
+        Source *last = m_heap.back();
+        m_heap.pop_back();
+        if (index < m_heap.size()) {
+            place(index, last);
+            updateSource(last);
+        }
+    }
+    m_sources.erase(it);
+}
+
+void IncrementalAggregateSensor::updateSource(Source *source)
+{
+    if (usesHeap()) {
+        siftUp(source->heapIndex);
+        siftDown(source->heapIndex);
+    }
+}
+
+void IncrementalAggregateSensor::recompute()
+{
+    m_sum = 0.0;
+    for (const auto &[sensor, source] : m_sources) {
+        source->value = sensor->value().toDouble();
+        m_sum += source->value;
+    }
+    m_sumUpdates = 0;
+
+    if (usesHeap()) {
+        for (std::size_t index = m_heap.size() / 2; index-- > 0;) {
+            siftDown(index);
+        }
+    }
+}
+
+void IncrementalAggregateSensor::publish()
+{
+    if (m_sources.empty()) {
+        setValue(m_initialValue);
+        return;
+    }
+
+    if (m_sumUpdates >= SumResyncInterval) {
+        recompute();
+    }
+
+    switch (m_function) {
+    case Function::Sum:
+        setValue(m_sum);
+        break;
+    case Function::Average:
+        setValue(m_sum / m_sources.size());
+        break;
+    case Function::Minimum:
+    case Function::Maximum:
+        setValue(m_heap.front()->value);
+        break;
+    }
+}
+
+bool IncrementalAggregateSensor::usesHeap() const
+{
+    return m_function == Function::Minimum || m_function == Function::Maximum;
+}
+
+bool IncrementalAggregateSensor::before(const Source *first, const Source *second) const
+{
+    return m_function == Function::Minimum ? first->value < second->value : first->value > second->value;
+}
+
+void IncrementalAggregateSensor::place(std::size_t index, Source *source)
+{
+    m_heap[index] = source;
+    source->heapIndex = index;
+}
+
+void IncrementalAggregateSensor::siftUp(std::size_t index)
+{
+    Source *source = m_heap[index];
+    while (index > 0) {
+        const std::size_t parent = (index - 1) / 2;
+        if (!before(source, m_heap[parent])) {
+            break;
+        }
+        place(index, m_heap[parent]);
+        index = parent;
+    }
+    place(index, source);
+}
+
+void IncrementalAggregateSensor::siftDown(std::size_t index)
+{
+    Source *source = m_heap[index];
+    while (true) {
+        std::size_t child = 2 * index + 1;
+        if (child >= m_heap.size()) {
+            break;
+        }
+        if (child + 1 < m_heap.size() && before(m_heap[child + 1], m_heap[child])) {
+            ++child;
+        }
+        if (!before(m_heap[child], source)) {
+            break;
+        }
+        place(index, m_heap[child]);
+        index = child;
+    }
+    place(index, source);
+}
+
+#include "moc_incrementalaggregatesensor.cpp"
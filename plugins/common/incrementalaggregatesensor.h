@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QPointer>
+#include <QRegularExpression>
+
+#include <systemstats/SensorProperty.h>
+
+namespace KSysGuard
+{
+class SensorContainer;
+class SensorObject;
+}
+
+/**
+ * A sensor that aggregates a property of all matching objects in its container.
+ *
+ * Unlike KSysGuard::AggregateSensor, which folds over all matched sensors whenever
+ * one of them changes, this keeps a running state that is updated with only the
+ * changed value: sums by the difference to the previous value and minimum and
+ * maximum through an indexed heap. The matched sensors are only looked up when
+ * objects are added to or removed from the container.
+ */
+class IncrementalAggregateSensor : public KSysGuard::SensorProperty
+{
+    Q_OBJECT
+
+public:
+    enum class Function {
+        Sum,
+        Average,
+        Minimum,
+        Maximum,
+    };
+    using FilterFunction = std::function<bool(const KSysGuard::SensorProperty *)>;
+
+    IncrementalAggregateSensor(KSysGuard::SensorObject *parent,
+                               const QString &id,
+                               const QString &name,
+                               Function function = Function::Sum,
+                               const QVariant &initialValue = QVariant());
+    ~IncrementalAggregateSensor() override;
+
+    /**
+     * Aggregates the property @p propertyId of all objects with an id matching
+     * @p objectIds, except this sensor's own object.
+     */
+    void setMatchSensors(const QRegularExpression &objectIds, const QString &propertyId);
+    /**
+     * Only aggregates sensors for which @p function returns true. It is called once
+     * when a sensor is matched, so it should not depend on values that change.
+     */
+    void setFilterFunction(const FilterFunction &function);
+
+    int matchCount() const;
+
+private:
+    struct Source {
+        double value = 0.0;
+        // Position in m_heap, only used for Minimum and Maximum
+        std::size_t heapIndex = 0;
+        QMetaObject::Connection valueChanged;
+        QMetaObject::Connection destroyed;
+    };
+
+    void updateMatches();
+    void addObject(KSysGuard::SensorObject *object);
+    void removeObject(KSysGuard::SensorObject *object);
+    void addSensor(KSysGuard::SensorProperty *sensor);
+    void removeSensor(KSysGuard::SensorProperty *sensor, bool destroyed = false);
+    void updateSource(Source *source);
+    void recompute();
+    void publish();
+
+    bool usesHeap() const;
+    bool before(const Source *first, const Source *second) const;
+    void place(std::size_t index, Source *source);
+    void siftUp(std::size_t index);
+    void siftDown(std::size_t index);
+
+    Function m_function;
+    QVariant m_initialValue;
+    QPointer<KSysGuard::SensorContainer> m_container;
+    QRegularExpression m_objectIds;
+    QString m_propertyId;
+    FilterFunction m_filterFunction;
+
+    std::unordered_map<KSysGuard::SensorProperty *, std::unique_ptr<Source>> m_sources;
+    std::vector<Source *> m_heap;
+    double m_sum = 0.0;
+    // Number of delta updates to the sum since it was last computed from scratch
+    int m_sumUpdates = 0;
+};
@@ -0,0 +1,176 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "readbatch.h"
+
+#ifdef HAVE_IO_URING
+#include <liburing.h>
+
+// Larger batches are submitted in several rounds
+constexpr unsigned RingEntries = 64;
+
+struct ReadBatch::Ring {
+    io_uring ring;
+    bool initialized = false;
+    // Files need to be registered again after one was added
+    bool registered = false;
+    bool hasRegisteredFiles = false;
+
+    ~Ring()
+    {
+        if (initialized) {
+            io_uring_queue_exit(&ring);
+        }
+    }
+};
+#else
+struct ReadBatch::Ring {
+};
+#endif
+
+ReadBatch::ReadBatch()
+{
+#ifdef HAVE_IO_URING
+    auto ring = std::make_unique<Ring>();
+    // Fails when the kernel is too old or io_uring is disabled, for example by a seccomp filter
+    if (io_uring_queue_init(RingEntries, &ring->ring, 0) == 0) {
+        ring->initialized = true;
+        m_ring = std::move(ring);
+    }
+#endif
+}
+
+ReadBatch::~ReadBatch()
+{
+    // The ring needs to go before the files it has registered
+    m_ring.reset();
+}
+
+int ReadBatch::addFile(const QString &path)
+{
+    SourceFile source(path);
+    if (!source.isOpen()) {
+        return -1;
+    }
+
+    m_files.push_back(File{std::move(source), true});
+#ifdef HAVE_IO_URING
+    if (m_ring) {
+        m_ring->registered = false;
+    }
+#endif
+    return int(m_files.size()) - 1;
+}
+
+void ReadBatch::setActive(int index, bool active)
+{
+    m_files[index].active = active;
+}
+
+void ReadBatch::submit()
+{
+    for (auto &file : m_files) {
+        file.source.m_size = 0;
+    }
+
+    if (m_ring) {
+        if (submitIoUring()) {
+            return;
+        }
+        // Something is wrong with the ring, do not try it again
+        m_ring.reset();
+    }
+
+    for (auto &file : m_files) {
+        if (file.active) {
+            file.source.read();
+        }
+    }
+}
+
+QByteArrayView ReadBatch::data(int index) const
+{
+    if (index < 0 || std::size_t(index) >= m_files.size()) {
+        return {};
+    }
+    return m_files[index].source.data();
+}
+
+bool ReadBatch::usesIoUring() const
+{
+    return bool(m_ring);
+}
+
+bool ReadBatch::submitIoUring()
+{
+#ifdef HAVE_IO_URING
+    io_uring *ring = &m_ring->ring;
+
+    if (!m_ring->registered) {
+        if (m_ring->hasRegisteredFiles) {
+            io_uring_unregister_files(ring);
+            m_ring->hasRegisteredFiles = false;
+        }
+        std::vector<int> fds;
+        fds.reserve(m_files.size());
+        for (const auto &file : m_files) {
+            fds.push_back(file.source.m_fd);
+        }
+        if (!fds.empty() && io_uring_register_files(ring, fds.data(), fds.size()) < 0) {
+            return false;
+        }
+        m_ring->hasRegisteredFiles = !fds.empty();
+        m_ring->registered = true;
+    }
+
+    std::size_t next = 0;
+    while (next < m_files.size()) {
+        unsigned queued = 0;
+        for (; next < m_files.size() && queued < RingEntries; ++next) {
+            auto &file = m_files[next];
+            if (!file.active) {
+                continue;
+            }
+            io_uring_sqe *sqe = io_uring_get_sqe(ring);
+            if (!sqe) {
+                break;
+            }
+            // With IOSQE_FIXED_FILE the index of the registered file is used instead of the descriptor
+            auto &buffer = file.source.m_buffer;
+            io_uring_prep_read(sqe, int(next), buffer.data(), buffer.size(), 0);
+            sqe->flags |= IOSQE_FIXED_FILE;
+            io_uring_sqe_set_data64(sqe, next);
+            ++queued;
+        }
+        if (queued == 0) {
+            break;
+        }
+
+        if (io_uring_submit_and_wait(ring, queued) < 0) {
+            return false;
+        }
+        for (unsigned i = 0; i < queued; ++i) {
+            io_uring_cqe *cqe = nullptr;
+            if (io_uring_wait_cqe(ring, &cqe) < 0) {
+                return false;
+            }
+            auto &source = m_files[io_uring_cqe_get_data64(cqe)].source;
+            if (cqe->res < 0) {
+                source.m_size = 0;
+            } else if (cqe->res < source.m_buffer.size()) {
+                source.m_size = cqe->res;
+            } else {
+                // Did not fit, this happens at most once per file as the buffer is kept
+                source.read();
+            }
+            io_uring_cqe_seen(ring, cqe);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "sourcefile.h"
+
+/**
+ * Rereads a set of small procfs and sysfs files once per update.
+ *
+ * The files are opened once and stay open. When io_uring is available all reads
+ * of an update are submitted together using registered file descriptors, which
+ * replaces a read per file with a single system call. Otherwise every file is
+ * read on its own like a SourceFile.
+ */
+class ReadBatch
+{
+public:
+    ReadBatch();
+    ~ReadBatch();
+
+    ReadBatch(const ReadBatch &) = delete;
+    ReadBatch &operator=(const ReadBatch &) = delete;
+
+    /**
+     * Adds @p path to the files read by submit().
+     * @return The index of the file, or -1 if it can not be opened.
+     */
+    int addFile(const QString &path);
+
+    /**
+     * Whether the file at @p index is read by submit(), files are active by default.
+     */
+    void setActive(int index, bool active);
+
+    /**
+     * Reads all active files.
+     */
+    void submit();
+
+    /**
+     * The contents of the file at @p index as read by the last submit(). Empty if
+     * reading failed or the file is not active.
+     */
+    QByteArrayView data(int index) const;
+
+    bool usesIoUring() const;
+
+private:
+    struct File {
+        SourceFile source;
+        bool active = true;
+    };
+
+    bool submitIoUring();
+
+    std::vector<File> m_files;
+
+    struct Ring;
+    std::unique_ptr<Ring> m_ring;
+};
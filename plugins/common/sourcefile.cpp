@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "sourcefile.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include <QFile>
+
+// Enough for nearly every procfs and sysfs file, larger ones grow the buffer on the first read
+constexpr qsizetype InitialBufferSize = 4096;
+
+SourceFile::SourceFile(const QString &path)
+{
+    open(path);
+}
+
+SourceFile::~SourceFile()
+{
+    close();
+}
+
+SourceFile::SourceFile(SourceFile &&other) noexcept
+    : m_fd(std::exchange(other.m_fd, -1))
+    , m_buffer(std::move(other.m_buffer))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+SourceFile &SourceFile::operator=(SourceFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_fd = std::exchange(other.m_fd, -1);
+        m_buffer = std::move(other.m_buffer);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+bool SourceFile::open(const QString &path)
+{
+    close();
+    m_fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        return false;
+    }
+    m_buffer.resize(InitialBufferSize);
+    return true;
+}
+
+bool SourceFile::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+QByteArrayView SourceFile::read()
+{
+    m_size = 0;
+    if (m_fd < 0) {
+        return {};
+    }
+
+    while (true) {
+        const ssize_t result = pread(m_fd, m_buffer.data(), m_buffer.size(), 0);
+        if (result < 0) {
+            return {};
+        }
+        if (result < m_buffer.size()) {
+            m_size = result;
+            return data();
+        }
+        // The file may be larger than the buffer, keep the larger buffer for the next time
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+}
+
+QByteArrayView SourceFile::data() const
+{
+    return QByteArrayView(m_buffer.constData(), m_size);
+}
+
+void SourceFile::close()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_size = 0;
+}
+
+namespace SourceText
+{
+QByteArrayView takeLine(QByteArrayView &text)
+{
+    const qsizetype end = text.indexOf('\n');
+    if (end < 0) {
+        return std::exchange(text, QByteArrayView());
+    }
+    const QByteArrayView line = text.first(end);
+    text = text.sliced(end + 1);
+    return line;
+}
+
+QByteArrayView takeField(QByteArrayView &text)
+{
+    auto isSpace = [](char c) {
+        return c == ' ' || c == '\t' || c == '\n';
+    };
+
+    qsizetype start = 0;
+    while (start < text.size() && isSpace(text[start])) {
+        ++start;
+    }
+    qsizetype end = start;
+    while (end < text.size() && !isSpace(text[end])) {
+        ++end;
+    }
+    const QByteArrayView field = text.sliced(start, end - start);
+    text = text.sliced(end);
+    return field;
+}
+}
@@ -0,0 +1,69 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+/**
+ * A procfs or sysfs file that is read again on every update.
+ *
+ * The file is opened once and reread from the start with pread() into a buffer
+ * that is kept between reads, so an update neither opens the file nor allocates.
+ * The returned views point into that buffer and stay valid until the next read.
+ */
+class SourceFile
+{
+public:
+    SourceFile() = default;
+    explicit SourceFile(const QString &path);
+    ~SourceFile();
+
+    SourceFile(SourceFile &&other) noexcept;
+    SourceFile &operator=(SourceFile &&other) noexcept;
+    SourceFile(const SourceFile &) = delete;
+    SourceFile &operator=(const SourceFile &) = delete;
+
+    bool open(const QString &path);
+    bool isOpen() const;
+
+    /**
+     * Reads the current contents of the file. Empty if the file is not open or
+     * reading failed.
+     */
+    QByteArrayView read();
+    /**
+     * The contents as of the last read().
+     */
+    QByteArrayView data() const;
+
+private:
+    friend class ReadBatch;
+
+    void close();
+
+    int m_fd = -1;
+    QByteArray m_buffer;
+    qsizetype m_size = 0;
+};
+
+/**
+ * Helpers for parsing the contents of a SourceFile without copying it.
+ */
+namespace SourceText
+{
+/**
+ * Removes the first line from @p text and returns it without the line break.
+ */
+QByteArrayView takeLine(QByteArrayView &text);
+/**
+ * Removes the first field separated by whitespace from @p text and returns it.
+ * Empty if there are no more fields.
+ */
+QByteArrayView takeField(QByteArrayView &text);
+}
@@ -9,6 +9,7 @@
 #include "loadaverages.h"
 
 #include <algorithm>
+#include <array>
 #include <vector>
 
 #include <sys/types.h>
@@ -20,6 +21,8 @@
 #include <systemstats/SensorContainer.h>
 #include <systemstats/SysctlSensor.h>
 
+#include "subscribedsources.h"
+
 namespace {
 
 /** Reads a sysctl into a typed buffer, return success-value
@@ -134,8 +137,7 @@ void FreeBsdCpuObject::update(long system, long user, long idle)
         return;
     }
 
-    m_temperature->update();
-    m_frequency->update();
+    updateSubscribed(std::array{m_temperature, m_frequency});
 }
 
 void FreeBsdAllCpusObject::update(long system, long user, long idle)
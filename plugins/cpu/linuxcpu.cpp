@@ -6,21 +6,17 @@
 
 #include "linuxcpu.h"
 
-#include <QFile>
-
 #include <sensors/sensors.h>
 #include <systemstats/SensorsFeatureSensor.h>
 
+#include "sourcefile.h"
+
 static double readCpuFreq(const QString &cpuId, const QString &attribute, bool &ok)
 {
     ok = false;
-    QFile file(QStringLiteral("/sys/devices/system/cpu/%1/cpufreq/").arg(cpuId)  + attribute);
-    bool open = file.open(QIODevice::ReadOnly);
-    if (open) {
-        // Remove trailing new line
-        return file.readAll().chopped(1).toUInt(&ok) / 1000.0; // CPUFreq reports values in kHZ
-    }
-    return 0;
+    SourceFile file(QStringLiteral("/sys/devices/system/cpu/%1/cpufreq/").arg(cpuId) + attribute);
+    const double frequency = file.read().trimmed().toUInt(&ok) / 1000.0; // CPUFreq reports values in kHZ
+    return ok ? frequency : 0;
 }
 
 LinuxCpuObject::LinuxCpuObject(const QString &id, const QString &name, double initialFrequency, KSysGuard::SensorContainer *parent)
@@ -58,7 +54,7 @@ void LinuxCpuObject::makeSensors()
     }
 }
 
-void LinuxCpuObject::update(long long system, long long user, long long wait, long long idle)
+void LinuxCpuObject::update(long long system, long long user, long long wait, long long idle, QByteArrayView frequency)
 {
     if (!isSubscribed()) {
         return;
@@ -72,21 +68,19 @@ void LinuxCpuObject::update(long long system, long long user, long long wait, lo
     m_wait->setValue(m_usageComputer.waitUsage);
     m_usage->setValue(m_usageComputer.totalUsage);
 
-    // Second try to get current frequency
+    // Second update the current frequency, read together with /proc/stat by the plugin
     bool ok = false;
-    // First try cpuinfo_cur_freq, it is the frequency the hardware runs at (https://www.kernel.org/doc/html/latest/admin-guide/pm/cpufreq.html)
-    int frequency = readCpuFreq(id(), QStringLiteral("cpuinfo_cur_freq"), ok);
-    if (!ok) {
-        frequency = readCpuFreq(id(), QStringLiteral("scaling_cur_freq"), ok);
-    }
+    const int currentFrequency = frequency.trimmed().toUInt(&ok) / 1000.0; // CPUFreq reports values in kHZ
     if (ok) {
-        m_frequency->setValue(frequency);
+        m_frequency->setValue(currentFrequency);
     }
     // FIXME Should we fall back to reading /proc/cpuinfo again when the above fails? Could have the 
     // frequency value changed even if the cpu apparently doesn't use CPUFreq?
 
     // Third update temperature
-    m_temperature->update();
+    if (m_temperature->isSubscribed()) {
+        m_temperature->update();
+    }
 }
 
 void LinuxAllCpusObject::update(long long system, long long user, long long wait, long long idle) {
@@ -7,6 +7,8 @@
 #ifndef LINUXCPU_H
 #define LINUXCPU_H
 
+#include <QByteArrayView>
+
 #include "cpu.h"
 #include "usagecomputer.h"
 
@@ -20,7 +22,11 @@ class LinuxCpuObject : public CpuObject
 public:
     LinuxCpuObject(const QString &id, const QString &name, double initialFrequency, KSysGuard::SensorContainer *parent);
 
-    void update(long long system, long long user, long long wait, long long idle);
+    /**
+     * @p frequency is the content of the cpufreq file for the current frequency, empty if
+     * it could not be read.
+     */
+    void update(long long system, long long user, long long wait, long long idle, QByteArrayView frequency);
     void initialize() override;
     void makeTemperatureSensor(const sensors_chip_name * constchipName, const sensors_feature * const feature);
 private:
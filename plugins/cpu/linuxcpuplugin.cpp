@@ -141,6 +141,20 @@ LinuxCpuPluginPrivate::LinuxCpuPluginPrivate(CpuPlugin *q, const QString &cpuInf
     m_allCpus->initialize();
     m_allCpus->setCounts(cpuCount, m_cpus.size());
 
+    m_statFile = m_reads.addFile(u"/proc/stat"_s);
+    for (auto it = m_cpus.cbegin(); it != m_cpus.cend(); ++it) {
+        const QString cpufreq = u"/sys/devices/system/cpu/"_s + it.value()->id() + u"/cpufreq/"_s;
+        // cpuinfo_cur_freq is the frequency the hardware runs at (https://www.kernel.org/doc/html/latest/admin-guide/pm/cpufreq.html)
+        // but usually only readable by root
+        int index = m_reads.addFile(cpufreq + u"cpuinfo_cur_freq"_s);
+        if (index < 0) {
+            index = m_reads.addFile(cpufreq + u"scaling_cur_freq"_s);
+        }
+        m_frequencyFiles.insert(it.key(), index);
+        if (index >= 0) {
+            m_sources.addProperty(index, it.value()->sensor(u"frequency"_s));
+        }
+    }
 }
 
 void LinuxCpuPluginPrivate::update()
@@ -152,34 +166,39 @@ void LinuxCpuPluginPrivate::update()
         return;
     }
 
+    for (auto it = m_frequencyFiles.cbegin(); it != m_frequencyFiles.cend(); ++it) {
+        if (it.value() >= 0) {
+            m_reads.setActive(it.value(), m_sources.isNeeded(it.value()));
+        }
+    }
+    m_reads.submit();
+
     // Parse /proc/stat to get usage values. The format is described at
     // https://www.kernel.org/doc/html/latest/filesystems/proc.html#miscellaneous-kernel-statistics-in-proc-stat
-    QFile stat(QStringLiteral("/proc/stat"));
-    stat.open(QIODevice::ReadOnly);
-    for (QByteArray line = stat.readLine(); !line.isNull(); line = stat.readLine()) {
-        auto values = line.simplified().split(' ');
+    QByteArrayView stat = m_reads.data(m_statFile);
+    while (!stat.isEmpty()) {
+        QByteArrayView line = SourceText::takeLine(stat);
         if (!line.startsWith("cpu")) {
             continue;
         }
 
-        long long user = values[1].toLongLong();
-        long long nice = values[2].toLongLong();
-        long long system = values[3].toLongLong();
-        long long idle = values[4].toLongLong();
-        long long iowait = values[5].toLongLong();
-        long long irq = values[6].toLongLong();
-        long long softirq = values[7].toLongLong();
-        long long steal = values[8].toLongLong();
+        const QByteArrayView name = SourceText::takeField(line);
+        long long values[8] = {};
+        for (auto &value : values) {
+            value = SourceText::takeField(line).toLongLong();
+        }
+        const auto [user, nice, system, idle, iowait, irq, softirq, steal] = values;
 
         // Total values just start with "cpu", single cpus are numbered cpu0, cpu1, ...
-        if (line.startsWith("cpu ")) {
+        if (name == "cpu") {
             m_allCpus->update(system + irq + softirq, user + nice , iowait + steal, idle);
-        } else if (line.startsWith("cpu")) {
-            auto cpu = m_cpus.value(std::atoi(line.mid(strlen("cpu"))));
+        } else {
+            const int id = name.sliced(strlen("cpu")).toInt();
+            auto cpu = m_cpus.value(id);
             if (cpu) {
-                cpu->update(system + irq + softirq, user + nice , iowait + steal, idle);
+                cpu->update(system + irq + softirq, user + nice , iowait + steal, idle, m_reads.data(m_frequencyFiles.value(id, -1)));
             } else {
-                qCWarning(KSYSTEMSTATS_CPU) << "Unknown CPU" << line;
+                qCWarning(KSYSTEMSTATS_CPU) << "Unknown CPU" << name;
             }
         }
     }
@@ -7,6 +7,8 @@
 #define LINUXCPUPLUGIN_H
 
 #include "cpuplugin_p.h"
+#include "readbatch.h"
+#include "subscribedsources.h"
 
 #include <QList>
 #include <QMultiHash>
@@ -28,6 +30,13 @@ private:
     QHash<int, LinuxCpuObject *> m_cpus;
     QMultiHash<QPair<int, int>, LinuxCpuObject * const> m_cpusBySystemIds;
     LoadAverages *m_loadAverages;
+
+    // /proc/stat and the current frequency of every cpu, read together in update()
+    ReadBatch m_reads;
+    int m_statFile = -1;
+    QHash<int, int> m_frequencyFiles;
+    // Keyed by file index in m_reads
+    SubscribedSources<int> m_sources;
 };
 
 #endif
@@ -7,11 +7,17 @@
 
 #include "disks.h"
 
+#include <algorithm>
+#include <memory>
+
 #ifdef Q_OS_FREEBSD
 #include <devstat.h>
 #include <libgeom.h>
 #endif
 
+#include <QPointer>
+#include <QPromise>
+#include <QTimer>
 #include <QUrl>
 
 #include <KIO/FileSystemFreeSpaceJob>
@@ -25,19 +31,24 @@
 #include <Solid/StorageDrive>
 #include <Solid/StorageVolume>
 
-#include <systemstats/AggregateSensor.h>
 #include <systemstats/SensorContainer.h>
 #include <systemstats/SensorObject.h>
 
+#include "incrementalaggregatesensor.h"
+
 class VolumeObject : public KSysGuard::SensorObject
 {
     Q_OBJECT
 public:
     VolumeObject(const Solid::Device &device, KSysGuard::SensorContainer *parent);
     bool isRootDevice() const;
-    void update();
+    KJob *update();
     void setBytes(quint64 read, quint64 written, qint64 elapsedTime);
 
+Q_SIGNALS:
+    void rateSubscribed();
+
+public:
     const QString udi;
     const QString mountPoint;
 private:
@@ -49,8 +60,11 @@ private:
     KSysGuard::SensorProperty *m_free = nullptr;
     KSysGuard::SensorProperty *m_readRate = nullptr;
     KSysGuard::SensorProperty *m_writeRate = nullptr;
+    QPointer<KJob> m_job;
     quint64 m_bytesRead = 0;
     quint64 m_bytesWritten = 0;
+    // Rates need a previous sample of this volume
+    bool m_hasBytes = false;
     bool m_rootDevice = false;
 };
 
@@ -96,6 +110,14 @@ VolumeObject::VolumeObject(const Solid::Device &device, KSysGuard::SensorContain
     m_writeRate->setUnit(KSysGuard::UnitByteRate);
     m_writeRate->setVariantType(QVariant::Double);
 
+    for (auto rate : {m_readRate, m_writeRate}) {
+        connect(rate, &KSysGuard::SensorProperty::subscribedChanged, this, [this](bool subscribed) {
+            if (subscribed) {
+                Q_EMIT rateSubscribed();
+            }
+        });
+    }
+
     if (volume->usage() != Solid::StorageVolume::PartitionTable) {
         m_used = new KSysGuard::SensorProperty("used", i18nc("@title", "Used Space"), this);
         m_used->setPrefix(name());
@@ -128,35 +150,45 @@ bool VolumeObject::isRootDevice() const
     return m_rootDevice;
 }
 
-void VolumeObject::update()
+KJob *VolumeObject::update()
 {
     if (mountPoint.isEmpty()) {
         // skip non-mounted partitions
-        return;
+        return nullptr;
+    }
+    if (m_job) {
+        // A mount that does not respond should not pile up jobs, nor hold up the other volumes
+        return nullptr;
     }
     auto job = KIO::fileSystemFreeSpace(QUrl::fromLocalFile(mountPoint));
+    m_job = job;
     connect(job, &KJob::result, this, [this, job]() {
         if (!job->error()) {
             KIO::filesize_t size = job->size();
             KIO::filesize_t available = job->availableSize();
             m_total->setValue(size);
             m_free->setValue(available);
-            m_free->setMax(size);
             m_used->setValue(size - available);
-            m_used->setMax(size);
+            // The size rarely changes, avoid a metadata change with every refresh
+            if (m_free->info().max != size) {
+                m_free->setMax(size);
+                m_used->setMax(size);
+            }
         }
     });
+    return job;
 }
 
 void VolumeObject::setBytes(quint64 read, quint64 written, qint64 elapsed)
 {
-    if (elapsed != 0) {
+    if (elapsed != 0 && m_hasBytes) {
         double seconds = elapsed / 1000.0;
         m_readRate->setValue((read - m_bytesRead) / seconds);
         m_writeRate->setValue((written - m_bytesWritten) / seconds);
     }
     m_bytesRead = read;
     m_bytesWritten = written;
+    m_hasBytes = true;
 }
 
 DisksPlugin::DisksPlugin(QObject *parent, const QVariantList &args)
@@ -217,7 +249,7 @@ void DisksPlugin::addDevice(const Solid::Device& device)
     }
     if (volume->usage() == Solid::StorageVolume::PartitionTable) {
         auto block = device.as<Solid::Block>();
-        m_volumesByDevice.insert(block->device(), new VolumeObject(device, container));
+        addVolume(block->device(), new VolumeObject(device, container));
         return;
     }
     auto access = device.as<Solid::StorageAccess>();
@@ -255,7 +287,14 @@ void DisksPlugin::createAccessibleVolumeObject(const Solid::Device &device)
     if (hasMountPoint) {
         return;
     }
-    m_volumesByDevice.insert(block->device(), new VolumeObject(device,  containers()[0]));
+    addVolume(block->device(), new VolumeObject(device,  containers()[0]));
+}
+
+void DisksPlugin::addVolume(const QString &device, VolumeObject *volume)
+{
+    m_volumesByDevice.insert(device, volume);
+    // Sample the rates right away, so the first update after subscribing already has a rate
+    connect(volume, &VolumeObject::rateSubscribed, this, &DisksPlugin::requestRateBaseline);
 }
 
 void DisksPlugin::addAggregateSensors()
@@ -276,14 +315,14 @@ void DisksPlugin::addAggregateSensors()
         return true;
     };
 
-    auto total = new KSysGuard::AggregateSensor(allDisks, "total", i18nc("@title", "Total Space"));
+    auto total = new IncrementalAggregateSensor(allDisks, "total", i18nc("@title", "Total Space"));
     total->setShortName(i18nc("@title Short for 'Total Space'", "Total"));
     total->setUnit(KSysGuard::UnitByte);
     total->setVariantType(QVariant::ULongLong);
     total->setMatchSensors(QRegularExpression("^.*$"), "total");
     total->setFilterFunction(filterFunction);
 
-    auto free = new KSysGuard::AggregateSensor(allDisks, "free", i18nc("@title", "Free Space"));
+    auto free = new IncrementalAggregateSensor(allDisks, "free", i18nc("@title", "Free Space"));
     free->setShortName(i18nc("@title Short for 'Free Space'", "Free"));
     free->setUnit(KSysGuard::UnitByte);
     free->setVariantType(QVariant::ULongLong);
@@ -291,7 +330,7 @@ void DisksPlugin::addAggregateSensors()
     free->setMatchSensors(QRegularExpression("^.*$"), "free");
     free->setFilterFunction(filterFunction);
 
-    auto used = new KSysGuard::AggregateSensor(allDisks, "used", i18nc("@title", "Used Space"));
+    auto used = new IncrementalAggregateSensor(allDisks, "used", i18nc("@title", "Used Space"));
     used->setShortName(i18nc("@title Short for 'Used Space'", "Used"));
     used->setUnit(KSysGuard::UnitByte);
     used->setVariantType(QVariant::ULongLong);
@@ -299,14 +338,14 @@ void DisksPlugin::addAggregateSensors()
     used->setMatchSensors(QRegularExpression("^.*$"), "used");
     used->setFilterFunction(filterFunction);
 
-    auto readRate = new KSysGuard::AggregateSensor(allDisks, "read", i18nc("@title", "Read Rate"), 0);
+    auto readRate = new IncrementalAggregateSensor(allDisks, "read", i18nc("@title", "Read Rate"), IncrementalAggregateSensor::Function::Sum, 0);
     readRate->setShortName(i18nc("@title Short for 'Read Rate'", "Read"));
     readRate->setUnit(KSysGuard::UnitByteRate);
     readRate->setVariantType(QVariant::Double);
     readRate->setMatchSensors(QRegularExpression("^(?!all).*$"), "read");
     readRate->setFilterFunction(filterFunction);
 
-    auto writeRate = new KSysGuard::AggregateSensor(allDisks, "write", i18nc("@title", "Write Rate"), 0);
+    auto writeRate = new IncrementalAggregateSensor(allDisks, "write", i18nc("@title", "Write Rate"), IncrementalAggregateSensor::Function::Sum, 0);
     writeRate->setShortName(i18nc("@title Short for 'Write Rate'", "Write"));
     writeRate->setUnit(KSysGuard::UnitByteRate);
     writeRate->setVariantType(QVariant::Double);
@@ -329,17 +368,55 @@ void DisksPlugin::addAggregateSensors()
 
 void DisksPlugin::update()
 {
-    bool anySubscribed = false;
-    for (auto volume : m_volumesByDevice) {
+    const bool anySubscribed = std::any_of(m_volumesByDevice.cbegin(), m_volumesByDevice.cend(), [](VolumeObject *volume) {
+        return volume->isSubscribed();
+    });
+    if (anySubscribed) {
+        updateRates();
+    }
+}
+
+QFuture<void> DisksPlugin::updateAsync()
+{
+    auto promise = std::make_shared<QPromise<void>>();
+    auto remainingJobs = std::make_shared<int>(0);
+    promise->start();
+
+    for (auto volume : std::as_const(m_volumesByDevice)) {
         if (volume->isSubscribed()) {
-            anySubscribed = true;
-            volume->update();
+            if (auto job = volume->update()) {
+                ++*remainingJobs;
+                // Connected after the volume's own handler, so the values are set by then
+                connect(job, &KJob::result, this, [promise, remainingJobs]() {
+                    if (--*remainingJobs == 0) {
+                        promise->finish();
+                    }
+                });
+            }
         }
     }
 
-    if (!anySubscribed) {
+    if (*remainingJobs == 0) {
+        promise->finish();
+    }
+    return promise->future();
+}
+
+void DisksPlugin::requestRateBaseline()
+{
+    if (m_rateBaselinePending) {
         return;
     }
+    // Once for all sensors subscribed together
+    m_rateBaselinePending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_rateBaselinePending = false;
+        updateRates();
+    });
+}
+
+void DisksPlugin::updateRates()
+{
 
     qint64 elapsed = 0;
     if (m_elapsedTimer.isValid()) {
@@ -348,11 +425,10 @@ void DisksPlugin::update()
         m_elapsedTimer.start();
     }
 #if defined Q_OS_LINUX
-    QFile diskstats("/proc/diskstats");
-    if (!diskstats.exists()) {
+    if (!m_diskstats.isOpen() && !m_diskstats.open(QStringLiteral("/proc/diskstats"))) {
         return;
     }
-    diskstats.open(QIODevice::ReadOnly | QIODevice::Text);
+    QByteArrayView diskstats = m_diskstats.read();
     /* procfs-diskstats (See https://www.kernel.org/doc/Documentation/ABI/testing/procfs-diskstats)
     The /proc/diskstats file displays the I/O statistics
     of block devices. Each line contains the following 14
@@ -369,12 +445,23 @@ void DisksPlugin::update()
     - sectors written
     [...]
     */
-    for (QByteArray line = diskstats.readLine(); !line.isNull(); line = diskstats.readLine()) {
-        QList<QByteArray> fields = line.simplified().split(' ');
-        const QString device = QStringLiteral("/dev/%1").arg(QString::fromLatin1(fields[2]));
-        if (m_volumesByDevice.contains(device)) {
+    // Reused for every line, so looking up the volume does not allocate
+    QString device = QStringLiteral("/dev/");
+    device.reserve(64);
+    while (!diskstats.isEmpty()) {
+        QByteArrayView line = SourceText::takeLine(diskstats);
+        QByteArrayView fields[10];
+        for (auto &field : fields) {
+            field = SourceText::takeField(line);
+        }
+        if (fields[9].isEmpty()) {
+            continue;
+        }
+        device.truncate(strlen("/dev/"));
+        device.append(QLatin1StringView(fields[2]));
+        if (auto volume = m_volumesByDevice.value(device)) {
             // A sector as reported in diskstats is 512 Bytes, see https://stackoverflow.com/a/38136179
-            m_volumesByDevice[device]->setBytes(fields[5].toULongLong() * 512, fields[9].toULongLong() * 512, elapsed);
+            volume->setBytes(fields[5].toULongLong() * 512, fields[9].toULongLong() * 512, elapsed);
         }
     }
 #elif defined Q_OS_FREEBSD
@@ -12,6 +12,12 @@
 
 #include "systemstats/SensorPlugin.h"
 
+#include <asyncupdateprovider.h>
+
+#ifdef Q_OS_LINUX
+#include "sourcefile.h"
+#endif
+
 namespace Solid {
     class Device;
     class StorageVolume;
@@ -19,10 +25,11 @@ namespace Solid {
 
 class VolumeObject;
 
-class DisksPlugin : public KSysGuard::SensorPlugin
+class DisksPlugin : public KSysGuard::SensorPlugin, public AsyncUpdateProvider
 
 {
     Q_OBJECT
+    Q_INTERFACES(AsyncUpdateProvider)
 public:
     DisksPlugin(QObject *parent, const QVariantList &args);
     QString providerName() const override
@@ -31,16 +38,26 @@ public:
     }
     ~DisksPlugin() override;
 
+    // Rates are read from /proc/diskstats with every frame
     void update() override;
+    // Free space is queried through KIO, which can take a while for network mounts
+    QFuture<void> updateAsync() override;
 
 
 private:
     void addDevice(const Solid::Device &device);
     void addAggregateSensors();
     void createAccessibleVolumeObject(const Solid::Device &device);
+    void addVolume(const QString &device, VolumeObject *volume);
+    void updateRates();
+    void requestRateBaseline();
 
     QHash<QString, VolumeObject*> m_volumesByDevice;
     QElapsedTimer m_elapsedTimer;
+    bool m_rateBaselinePending = false;
+#ifdef Q_OS_LINUX
+    SourceFile m_diskstats;
+#endif
 };
 
 #endif
@@ -8,10 +8,7 @@
 
 #include "systemstats/SensorObject.h"
 
-namespace KSysGuard
-{
-    class AggregateSensor;
-}
+class IncrementalAggregateSensor;
 
 class AllGpus : public KSysGuard::SensorObject
 {
@@ -21,7 +18,7 @@ public:
     AllGpus(KSysGuard::SensorContainer *parent);
 
 private:
-    KSysGuard::AggregateSensor *m_usageSensor = nullptr;
-    KSysGuard::AggregateSensor *m_totalVramSensor = nullptr;
-    KSysGuard::AggregateSensor *m_usedVramSensor = nullptr;
+    IncrementalAggregateSensor *m_usageSensor = nullptr;
+    IncrementalAggregateSensor *m_totalVramSensor = nullptr;
+    IncrementalAggregateSensor *m_usedVramSensor = nullptr;
 };
@@ -11,9 +11,10 @@
 #include <linux/pci.h>
 #include <sensors/sensors.h>
 
-#include <systemstats/SysFsSensor.h>
 #include <systemstats/SensorsFeatureSensor.h>
 
+#include "subscribedsources.h"
+
 int ppTableGetMax(const QByteArray &table)
 {
     const auto lines = table.split('\n');
@@ -70,13 +71,23 @@ void LinuxAmdGpu::initialize()
 
 void LinuxAmdGpu::update()
 {
-    for (auto sensor : std::as_const(m_sysFsSensors)) {
-        sensor->update();
+    bool anySubscribed = false;
+    for (const auto &source : m_sysFsSources) {
+        m_reads.setActive(source.file, source.property->isSubscribed());
+        anySubscribed = anySubscribed || source.property->isSubscribed();
     }
-    for (auto sensor : std::as_const(m_sensorsSensors)) {
-        sensor->update();
+    if (anySubscribed) {
+        m_reads.submit();
+        for (const auto &source : m_sysFsSources) {
+            const QByteArrayView data = m_reads.data(source.file);
+            if (source.property->isSubscribed() && !data.isEmpty()) {
+                source.property->setValue(source.convert(data));
+            }
+        }
     }
-    m_temperatureProperty->update();
+
+    // Includes the temperature, if lmsensors knows about it
+    updateSubscribed(m_sensorsSensors);
 }
 
 void LinuxAmdGpu::makeSensors()
@@ -86,27 +97,24 @@ void LinuxAmdGpu::makeSensors()
     m_nameProperty = new KSysGuard::SensorProperty(QStringLiteral("name"), this);
     m_totalVramProperty = new KSysGuard::SensorProperty(QStringLiteral("totalVram"),  this);
 
-    auto sensor = new KSysGuard::SysFsSensor(QStringLiteral("usage"), devicePath % QStringLiteral("/gpu_busy_percent"), 0, this);
-    m_usageProperty = sensor;
-    m_sysFsSensors << sensor;
+    auto toNumber = [](QByteArrayView input) {
+        return QVariant(input.trimmed().toLongLong());
+    };
+    auto ppTableCurrent = [](QByteArrayView input) {
+        return QVariant(ppTableGetCurrent(input.toByteArray()));
+    };
 
-    sensor = new KSysGuard::SysFsSensor(QStringLiteral("usedVram"), devicePath % QStringLiteral("/mem_info_vram_used"), this);
-    m_usedVramProperty = sensor;
-    m_sysFsSensors << sensor;
+    m_usageProperty = new KSysGuard::SensorProperty(QStringLiteral("usage"), QString(), 0, this);
+    addSysFsSensor(m_usageProperty, devicePath % QStringLiteral("/gpu_busy_percent"), toNumber);
 
-    sensor = new KSysGuard::SysFsSensor(QStringLiteral("coreFrequency"), devicePath % QStringLiteral("/pp_dpm_sclk"), 0, this);
-    sensor->setConvertFunction([](const QByteArray &input) {
-        return ppTableGetCurrent(input);
-    });
-    m_coreFrequencyProperty = sensor;
-    m_sysFsSensors << sensor;
+    m_usedVramProperty = new KSysGuard::SensorProperty(QStringLiteral("usedVram"), this);
+    addSysFsSensor(m_usedVramProperty, devicePath % QStringLiteral("/mem_info_vram_used"), toNumber);
 
-    sensor = new KSysGuard::SysFsSensor(QStringLiteral("memoryFrequency"), devicePath % QStringLiteral("/pp_dpm_mclk"), 0, this);
-    sensor->setConvertFunction([](const QByteArray &input) {
-        return ppTableGetCurrent(input);
-    });
-    m_memoryFrequencyProperty = sensor;
-    m_sysFsSensors << sensor;
+    m_coreFrequencyProperty = new KSysGuard::SensorProperty(QStringLiteral("coreFrequency"), QString(), 0, this);
+    addSysFsSensor(m_coreFrequencyProperty, devicePath % QStringLiteral("/pp_dpm_sclk"), ppTableCurrent);
+
+    m_memoryFrequencyProperty = new KSysGuard::SensorProperty(QStringLiteral("memoryFrequency"), QString(), 0, this);
+    addSysFsSensor(m_memoryFrequencyProperty, devicePath % QStringLiteral("/pp_dpm_mclk"), ppTableCurrent);
 
     discoverSensors();
 
@@ -121,6 +129,14 @@ void LinuxAmdGpu::makeSensors()
     }
 }
 
+void LinuxAmdGpu::addSysFsSensor(KSysGuard::SensorProperty *property, const QString &path, const std::function<QVariant(QByteArrayView)> &convert)
+{
+    const int file = m_reads.addFile(path);
+    if (file >= 0) {
+        m_sysFsSources.push_back(SysFsSource{property, file, convert});
+    }
+}
+
 void LinuxAmdGpu::discoverSensors()
 {
     sensors_chip_name match;
@@ -6,15 +6,14 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "GpuDevice.h"
+#include "readbatch.h"
 
 struct udev_device;
 
-namespace KSysGuard
-{
-    class SysFsSensor;
-}
-
 class LinuxAmdGpu : public GpuDevice
 {
     Q_OBJECT
@@ -31,8 +30,18 @@ protected:
 
 private:
     void discoverSensors();
+    void addSysFsSensor(KSysGuard::SensorProperty *property, const QString &path, const std::function<QVariant(QByteArrayView)> &convert);
+
+    // A property read from a sysfs attribute of the device
+    struct SysFsSource {
+        KSysGuard::SensorProperty *property;
+        int file;
+        std::function<QVariant(QByteArrayView)> convert;
+    };
 
     udev_device *m_device;
-    QList<KSysGuard::SysFsSensor *> m_sysFsSensors;
+    // The attributes of subscribed properties are read together in one batch
+    ReadBatch m_reads;
+    std::vector<SysFsSource> m_sysFsSources;
     QList<KSysGuard::SensorProperty *> m_sensorsSensors;
 };
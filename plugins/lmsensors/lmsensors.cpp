@@ -16,6 +16,8 @@
 
 #include <sensors/sensors.h>
 
+#include "subscribedsources.h"
+
 LmSensorsPlugin::LmSensorsPlugin(QObject *parent, const QVariantList &args)
     : KSysGuard::SensorPlugin(parent, args)
 {
@@ -67,9 +69,12 @@ QString LmSensorsPlugin::providerName() const
 
 void LmSensorsPlugin::update()
 {
-    for (auto sensor : std::as_const(m_sensors)) {
-        sensor->update();
-    }
+    updateSubscribed(m_sensors);
+}
+
+void LmSensorsPlugin::sampleBurst()
+{
+    update();
 }
 
 K_PLUGIN_CLASS_WITH_JSON(LmSensorsPlugin, "metadata.json")
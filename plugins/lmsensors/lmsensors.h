@@ -9,18 +9,23 @@
 
 #include <systemstats/SensorPlugin.h>
 
+#include <burstsampleprovider.h>
+
 namespace KSysGuard
 {
 class SensorsFeatureSensor;
 }
-class LmSensorsPlugin : public KSysGuard::SensorPlugin
+class LmSensorsPlugin : public KSysGuard::SensorPlugin, public BurstSampleProvider
 {
     Q_OBJECT
+    Q_INTERFACES(BurstSampleProvider)
 public:
     LmSensorsPlugin(QObject *parent, const QVariantList &args);
     ~LmSensorsPlugin() override;
     QString providerName() const override;
     void update() override;
+    // The readings do not depend on the previous update
+    void sampleBurst() override;
 private:
     QList<KSysGuard::SensorsFeatureSensor *> m_sensors;
 };
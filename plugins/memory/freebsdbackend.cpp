@@ -67,6 +67,12 @@ void FreeBsdMemoryBackend::makeSensors()
     m_swapUsed = new KSysGuard::SensorProperty(QStringLiteral("used"), m_swapObject);
     m_swapFree = new KSysGuard::SensorProperty(QStringLiteral("free"), m_swapObject);
 
+    for (auto sensor : std::as_const(m_sysctlSensors)) {
+        m_sources.addProperty(sensor, sensor);
+    }
+    // Computed from other sysctls in update()
+    m_sources.addProperty(m_total, m_used);
+    m_sources.addProperty(m_free, m_used);
 }
 
 unsigned long long FreeBsdMemoryBackend::pagesToBytes(uint32_t pages)
@@ -86,14 +92,18 @@ void FreeBsdMemoryBackend::update()
     }
 
     for (const auto sysctlSensor : m_sysctlSensors) {
-        sysctlSensor->update();
+        if (m_sources.isNeeded(sysctlSensor)) {
+            sysctlSensor->update();
+        }
     }
 
-    m_used->setValue(m_total->value().toULongLong() - m_free->value().toULongLong());
+    if (m_used->isSubscribed()) {
+        m_used->setValue(m_total->value().toULongLong() - m_free->value().toULongLong());
+    }
 
     uint32_t activePages = 0;
     uint32_t inactivePages = 0;
-    if (readSysctl("vm.stats.vm.v_active_count", &activePages) && readSysctl("vm.stats.vm.v_inactive_count", &inactivePages)) {
+    if (m_application->isSubscribed() && readSysctl("vm.stats.vm.v_active_count", &activePages) && readSysctl("vm.stats.vm.v_inactive_count", &inactivePages)) {
         m_application->setValue(pagesToBytes(activePages + inactivePages));
     }
 }
@@ -8,6 +8,7 @@
 #define FREEBSDBACKEND_H
 
 #include "backend.h"
+#include "subscribedsources.h"
 
 #include <QList>
 
@@ -29,6 +30,7 @@ private:
     unsigned int m_pageSize;
     kvm_t *m_kd;
     QList<KSysGuard::SensorProperty *> m_sysctlSensors;
+    SubscribedSources<KSysGuard::SensorProperty *> m_sources;
 };
 
 #endif
@@ -10,10 +10,9 @@
 #include <systemstats/SensorObject.h>
 #include <systemstats/SensorProperty.h>
 
-#include <QFile>
-
 LinuxMemoryBackend::LinuxMemoryBackend(KSysGuard::SensorContainer *container)
     : MemoryBackend(container)
+    , m_meminfo(QStringLiteral("/proc/meminfo"))
 {
 }
 
@@ -23,19 +22,22 @@ void LinuxMemoryBackend::update()
         return;
     }
 
-    QFile meminfo(QStringLiteral("/proc/meminfo"));
-    meminfo.open(QIODevice::ReadOnly);
+    QByteArrayView meminfo = m_meminfo.read();
     // The format of the file is as follows:
     // Fieldname:[whitespace]value kB
     // A description of the fields can be found at 
     // https://www.kernel.org/doc/html/latest/filesystems/proc.html#meminfo
-    unsigned long long total, free, available, buffer, cache, slab, swapTotal, swapFree;
-    for (QByteArray line = meminfo.readLine(); !line.isEmpty(); line = meminfo.readLine()) {
-        int colonIndex = line.indexOf(':');
-        const auto fields = line.simplified().split(' ');
+    unsigned long long total = 0, free = 0, available = 0, buffer = 0, cache = 0, slab = 0, swapTotal = 0, swapFree = 0;
+    while (!meminfo.isEmpty()) {
+        QByteArrayView line = SourceText::takeLine(meminfo);
+        const qsizetype colonIndex = line.indexOf(':');
+        if (colonIndex < 0) {
+            continue;
+        }
 
-        const QByteArray name = line.left(colonIndex);
-        const unsigned long long value = std::strtoull(line.mid(colonIndex + 1), nullptr, 10) * 1024;
+        const QByteArrayView name = line.first(colonIndex);
+        line = line.sliced(colonIndex + 1);
+        const unsigned long long value = SourceText::takeField(line).toULongLong() * 1024;
         if (name == "MemTotal") {
             total = value;
         } else if (name == "MemFree") {
@@ -8,11 +8,14 @@
 #define LINUXBACKEND_H
 
 #include "backend.h"
+#include "sourcefile.h"
 
 class LinuxMemoryBackend : public MemoryBackend {
 public:
     LinuxMemoryBackend(KSysGuard::SensorContainer *container);
     void update() override;
+private:
+    SourceFile m_meminfo;
 };
 
 #endif
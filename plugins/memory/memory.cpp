@@ -37,6 +37,11 @@ void MemoryPlugin::update()
     m_backend->update();
 }
 
+void MemoryPlugin::sampleBurst()
+{
+    m_backend->update();
+}
+
 K_PLUGIN_CLASS_WITH_JSON(MemoryPlugin, "metadata.json")
 #include "memory.moc"
 
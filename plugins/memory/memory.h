@@ -11,13 +11,16 @@
 
 #include <QObject>
 
+#include <burstsampleprovider.h>
+
 #include <memory>
 
 class MemoryBackend;
 
-class MemoryPlugin : public KSysGuard::SensorPlugin
+class MemoryPlugin : public KSysGuard::SensorPlugin, public BurstSampleProvider
 {
     Q_OBJECT
+    Q_INTERFACES(BurstSampleProvider)
 public:
     MemoryPlugin(QObject *parent, const QVariantList &args);
     ~MemoryPlugin();
@@ -27,6 +30,8 @@ public:
         return QStringLiteral("memory");
     }
     void update() override;
+    // The usage does not depend on the previous update
+    void sampleBurst() override;
 private:
     std::unique_ptr<MemoryBackend> m_backend;
 };
@@ -8,13 +8,9 @@
 
 #include <systemstats/SensorObject.h>
 
+class IncrementalAggregateSensor;
 class NetworkDevice;
 
-namespace KSysGuard
-{
-    class AggregateSensor;
-}
-
 /**
  * This object aggregates the network usage of all devices.
  */
@@ -26,10 +22,10 @@ public:
     AllDevicesObject(KSysGuard::SensorContainer* parent);
 
 private:
-    KSysGuard::AggregateSensor *m_downloadSensor = nullptr;
-    KSysGuard::AggregateSensor *m_uploadSensor = nullptr;
-    KSysGuard::AggregateSensor *m_downloadBitsSensor = nullptr;
-    KSysGuard::AggregateSensor *m_uploadBitsSensor = nullptr;
-    KSysGuard::AggregateSensor *m_totalDownloadSensor = nullptr;
-    KSysGuard::AggregateSensor *m_totalUploadSensor = nullptr;
+    IncrementalAggregateSensor *m_downloadSensor = nullptr;
+    IncrementalAggregateSensor *m_uploadSensor = nullptr;
+    IncrementalAggregateSensor *m_downloadBitsSensor = nullptr;
+    IncrementalAggregateSensor *m_uploadBitsSensor = nullptr;
+    IncrementalAggregateSensor *m_totalDownloadSensor = nullptr;
+    IncrementalAggregateSensor *m_totalUploadSensor = nullptr;
 };
@@ -78,19 +78,24 @@ NetworkManagerDevice::NetworkManagerDevice(const QString &id, QSharedPointer<Net
     m_statisticsTimer = std::make_unique<QTimer>();
     m_statisticsTimer->setInterval(UpdateRate);
     connect(m_statisticsTimer.get(), &QTimer::timeout, this, [this]() {
+        const qint64 elapsed = m_statisticsElapsed.restart();
+        if (elapsed <= 0) {
+            return;
+        }
+
         auto newDownload = m_statistics->rxBytes();
         auto previousDownload = m_totalDownloadSensor->value().toULongLong();
         if (previousDownload > 0) {
-            m_downloadSensor->setValue((newDownload - previousDownload) * (1000 / UpdateRate));
-            m_downloadBitsSensor->setValue((newDownload - previousDownload) * (1000 / UpdateRate) * 8);
+            m_downloadSensor->setValue((newDownload - previousDownload) * 1000 / elapsed);
+            m_downloadBitsSensor->setValue((newDownload - previousDownload) * 1000 / elapsed * 8);
         }
         m_totalDownloadSensor->setValue(newDownload);
 
         auto newUpload = m_statistics->txBytes();
         auto previousUpload = m_totalUploadSensor->value().toULongLong();
         if (previousUpload > 0) {
-            m_uploadSensor->setValue((newUpload - previousUpload) * (1000 / UpdateRate));
-            m_uploadBitsSensor->setValue((newUpload - previousUpload) * (1000 / UpdateRate) * 8);
+            m_uploadSensor->setValue((newUpload - previousUpload) * 1000 / elapsed);
+            m_uploadBitsSensor->setValue((newUpload - previousUpload) * 1000 / elapsed * 8);
         }
         m_totalUploadSensor->setValue(newUpload);
     });
@@ -99,7 +104,7 @@ NetworkManagerDevice::NetworkManagerDevice(const QString &id, QSharedPointer<Net
     for (auto property : statisticSensors) {
         connect(property, &KSysGuard::SensorProperty::subscribedChanged, this, [this, statisticSensors](bool subscribed) {
             if (subscribed && !m_statisticsTimer->isActive()) {
-                m_statisticsTimer->start();
+                startStatistics();
             } else if (std::none_of(statisticSensors.begin(), statisticSensors.end(), [](auto property) { return property->isSubscribed(); })) {
                 m_statisticsTimer->stop();
                 m_totalDownloadSensor->setValue(0);
@@ -125,6 +130,15 @@ NetworkManagerDevice::~NetworkManagerDevice()
     m_statistics->setRefreshRateMs(m_initialStatisticsRate);
 }
 
+void NetworkManagerDevice::startStatistics()
+{
+    // The first sample only serves as baseline for the rates, take it right away
+    m_totalDownloadSensor->setValue(m_statistics->rxBytes());
+    m_totalUploadSensor->setValue(m_statistics->txBytes());
+    m_statisticsElapsed.start();
+    m_statisticsTimer->start();
+}
+
 void NetworkManagerDevice::update()
 {
     if (!m_device->activeConnection()) {
@@ -144,7 +158,7 @@ void NetworkManagerDevice::update()
     if (m_device->activeConnection() && !m_connected) {
         m_connected = true;
         if (m_restoreTimer) {
-            m_statisticsTimer->start();
+            startStatistics();
         }
 
         Q_EMIT connected(this);
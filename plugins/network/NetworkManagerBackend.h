@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <QElapsedTimer>
 #include <QHash>
 
 #include "NetworkBackend.h"
@@ -38,11 +39,14 @@ public:
 
 private:
     void updateWifi();
+    void startStatistics();
 
     QSharedPointer<NetworkManager::Device> m_device;
     QSharedPointer<NetworkManager::DeviceStatistics> m_statistics;
     NetworkManager::WirelessDevice *m_wifiDevice = nullptr;
     std::unique_ptr<QTimer> m_statisticsTimer;
+    // Time since the previous sample, the timer may fire late or the baseline be taken in between
+    QElapsedTimer m_statisticsElapsed;
     bool m_connected = false;
     bool m_restoreTimer = false;
     uint m_initialStatisticsRate;
@@ -13,6 +13,7 @@
 #include <QNetworkAddressEntry>
 #include <QHostAddress>
 #include <QString>
+#include <QTimer>
 #include <array>
 
 #include <netlink/netlink.h>
@@ -45,6 +46,11 @@ RtNetlinkDevice::RtNetlinkDevice(const QString &id)
     };
     for (auto property : statisticSensors) {
         connect(property, &KSysGuard::SensorProperty::subscribedChanged, this, resetStatistics);
+        connect(property, &KSysGuard::SensorProperty::subscribedChanged, this, [this](bool subscribed) {
+            if (subscribed) {
+                Q_EMIT baselineNeeded();
+            }
+        });
     }
     connect(this, &RtNetlinkDevice::disconnected, this, resetStatistics);
 
@@ -70,7 +76,8 @@ void RtNetlinkDevice::update(rtnl_link *link, nl_cache *address_cache, nl_cache
 
     const qulonglong downloadedBytes = rtnl_link_get_stat(link, RTNL_LINK_RX_BYTES);
     const qulonglong previousDownloadedBytes = m_totalDownloadSensor->value().toULongLong();
-    if (previousDownloadedBytes != 0) {
+    // An update requested for a baseline can come right before a regular one
+    if (previousDownloadedBytes != 0 && elapsedTime > 0) {
         m_downloadSensor->setValue((downloadedBytes - previousDownloadedBytes) * 1000 / elapsedTime);
         m_downloadBitsSensor->setValue((downloadedBytes - previousDownloadedBytes) * 1000 / elapsedTime * 8);
     }
@@ -78,12 +85,23 @@ void RtNetlinkDevice::update(rtnl_link *link, nl_cache *address_cache, nl_cache
 
     const qulonglong uploadedBytes = rtnl_link_get_stat(link, RTNL_LINK_TX_BYTES);
     const qulonglong previousUploadedBytes = m_totalUploadSensor->value().toULongLong();
-    if (previousUploadedBytes != 0) {
+    if (previousUploadedBytes != 0 && elapsedTime > 0) {
         m_uploadSensor->setValue((uploadedBytes - previousUploadedBytes) * 1000 / elapsedTime);
         m_uploadBitsSensor->setValue((uploadedBytes - previousUploadedBytes) * 1000 / elapsedTime * 8);
     }
     m_totalUploadSensor->setValue(uploadedBytes);
 
+    // The caches are only read if any device needs them
+    if (address_cache) {
+        updateAddresses(link, address_cache);
+    }
+    if (route_cache) {
+        updateGateways(link, route_cache);
+    }
+}
+
+void RtNetlinkDevice::updateAddresses(rtnl_link *link, nl_cache *address_cache)
+{
     m_ipv4Sensor->setValue(QString());
     m_ipv4SubnetMaskSensor->setValue(QString{});
     m_ipv4WithPrefixLengthSensor->setValue(QString{});
@@ -130,6 +148,11 @@ void RtNetlinkDevice::update(rtnl_link *link, nl_cache *address_cache, nl_cache
         }
     }, this);
 
+    rtnl_addr_put(filterAddress);
+}
+
+void RtNetlinkDevice::updateGateways(rtnl_link *link, nl_cache *route_cache)
+{
     m_ipv4GatewaySensor->setValue(QString());
     m_ipv6GatewaySensor->setValue(QString());
     // The gateway is found using a filter on the destination address with size = 0
@@ -152,7 +175,6 @@ void RtNetlinkDevice::update(rtnl_link *link, nl_cache *address_cache, nl_cache
         }
     }, this);
 
-    rtnl_addr_put(filterAddress);
     nl_addr_put(dst);
     rtnl_route_put(routeFilter);
 }
@@ -186,24 +208,42 @@ void RtNetlinkBackend::stop()
 {
 }
 
+void RtNetlinkBackend::requestBaseline()
+{
+    if (m_baselinePending) {
+        return;
+    }
+    // Once for all sensors subscribed together. Rates need a previous sample, taking it
+    // now lets the next update already report a rate.
+    m_baselinePending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_baselinePending = false;
+        update();
+    });
+}
+
 void RtNetlinkBackend::update()
 {
     const qint64 elapsedTime = m_updateTimer.restart();
-    nl_cache *link_cache, *address_cache, *route_cache;
+    nl_cache *link_cache, *address_cache = nullptr, *route_cache = nullptr;
     int error = rtnl_link_alloc_cache(m_socket.get(), AF_UNSPEC, &link_cache);
     if (error != 0) {
         qCWarning(KSYSTEMSTATS_NETWORK) << nl_geterror(error);
         return;
     }
-    error = rtnl_addr_alloc_cache(m_socket.get(), &address_cache);
-    if (error != 0) {
-        qCWarning(KSYSTEMSTATS_NETWORK) << nl_geterror(error);
-        return;
+    if (m_sources.isNeeded(Addresses)) {
+        error = rtnl_addr_alloc_cache(m_socket.get(), &address_cache);
+        if (error != 0) {
+            qCWarning(KSYSTEMSTATS_NETWORK) << nl_geterror(error);
+            return;
+        }
     }
-    error = rtnl_route_alloc_cache(m_socket.get(), AF_UNSPEC, 0, &route_cache);
-    if (error != 0) {
-        qCWarning(KSYSTEMSTATS_NETWORK) << nl_geterror(error);
-        return;
+    if (m_sources.isNeeded(Routes)) {
+        error = rtnl_route_alloc_cache(m_socket.get(), AF_UNSPEC, 0, &route_cache);
+        if (error != 0) {
+            qCWarning(KSYSTEMSTATS_NETWORK) << nl_geterror(error);
+            return;
+        }
     }
 
     for (nl_object *object = nl_cache_get_first(link_cache); object != nullptr; object = nl_cache_get_next(object)) {
@@ -220,14 +260,25 @@ void RtNetlinkBackend::update()
         if (!m_devices.contains(name)) {
             auto device = new RtNetlinkDevice(name);
             m_devices.insert(name, device);
+            for (const auto id : {"ipv4address", "ipv4subnet", "ipv4withPrefixLength", "ipv6address", "ipv6subnet", "ipv6withPrefixLength"}) {
+                m_sources.addProperty(Addresses, device->sensor(QString::fromLatin1(id)));
+            }
+            for (const auto id : {"ipv4gateway", "ipv6gateway"}) {
+                m_sources.addProperty(Routes, device->sensor(QString::fromLatin1(id)));
+            }
+            connect(device, &RtNetlinkDevice::baselineNeeded, this, &RtNetlinkBackend::requestBaseline);
             connect(device, &RtNetlinkDevice::connected, this, [device, this] { Q_EMIT deviceAdded(device); });
             connect(device, &RtNetlinkDevice::disconnected, this, [device, this] { Q_EMIT deviceRemoved(device); });
         }
         m_devices[name]->update(link, address_cache, route_cache, elapsedTime);
     }
     nl_cache_free(link_cache);
-    nl_cache_free(address_cache);
-    nl_cache_free(route_cache);
+    if (address_cache) {
+        nl_cache_free(address_cache);
+    }
+    if (route_cache) {
+        nl_cache_free(route_cache);
+    }
 }
 
 #include "moc_RtNetlinkBackend.cpp"
@@ -12,6 +12,8 @@
 
 #include <QElapsedTimer>
 
+#include "subscribedsources.h"
+
 #include <netlink/cache.h>
 #include <netlink/socket.h>
 
@@ -27,8 +29,13 @@ public:
 Q_SIGNALS:
     void connected();
     void disconnected();
+    // A rate sensor was subscribed and needs a first sample
+    void baselineNeeded();
 
 private:
+    void updateAddresses(rtnl_link *link, nl_cache *address_cache);
+    void updateGateways(rtnl_link *link, nl_cache *route_cache);
+
     bool m_connected = false;
 };
 
@@ -43,7 +50,17 @@ public:
     void update() override;
 
 private:
+    // The netlink caches that are only needed for some of the properties
+    enum Source {
+        Addresses,
+        Routes,
+    };
+
+    void requestBaseline();
+
     QHash<QByteArray, RtNetlinkDevice *> m_devices;
+    SubscribedSources<Source> m_sources;
     std::unique_ptr<nl_sock, decltype(&nl_socket_free)> m_socket;
     QElapsedTimer m_updateTimer;
+    bool m_baselinePending = false;
 };
@@ -172,6 +172,9 @@ void OSInfoPrivate::init()
 
 void OSInfoPrivate::update()
 {
+    if (!uptimeProperty->isSubscribed()) {
+        return;
+    }
 #if defined Q_OS_LINUX
     struct sysinfo info;
     sysinfo(&info);
@@ -11,7 +11,6 @@
 
 #include <KPluginFactory>
 #include <KLocalizedString>
-#include <QFile>
 
 #include <systemstats/SensorContainer.h>
 #include <systemstats/SensorObject.h>
@@ -38,90 +37,65 @@ struct PressureData {
 };
 
 /**
- * Read a file from /proc and process it into an instance of PressureData.
- * 
- * Filename is specified as the name of the virtual file to read that will be appended to /proc/pressure/, for example "memory", "cpu", or "io"
+ * Process the contents of a file from /proc/pressure into an instance of PressureData.
  *
- * File contents returned looks like this:
+ * File is one of the virtual files in /proc/pressure/, for example "memory", "cpu", or "io"
+ *
+ * File contents look like this:
  * some avg10=0.00 avg60=0.00 avg300=0.00 total=16304493
  * full avg10=0.00 avg60=0.00 avg300=0.00 total=15066192
  *
  * Returns a PressureData structure containing the parsed data
  */
-PressureData parseDataFromFile(const QString fileSelector) {
-
-    qCDebug(KSYSTEMSTATS_PRESSURE) << "Parsing " << "/proc/pressure/" << fileSelector;
-        
-    QFile pressureInfoFile(QStringLiteral("/proc/pressure/") + fileSelector);
-    bool open = pressureInfoFile.open(QIODevice::ReadOnly);
-
-    static const QByteArray avg10DataLabel = QByteArrayLiteral("avg10");
-    static const QByteArray avg60DataLabel = QByteArrayLiteral("avg60");
-    static const QByteArray avg300DataLabel = QByteArrayLiteral("avg300");
-    static const QByteArray totalDataLabel = QByteArrayLiteral("total");
+PressureData parseData(QByteArrayView contents) {
 
-    static const QByteArray someDataLabel = QByteArrayLiteral("some");
-    static const QByteArray fullDataLabel = QByteArrayLiteral("full");
-
-    if (!open) {
-        // You can choose how to handle the error case, such as throwing an exception
-        // or returning a default-initialized Data structure.
+    if (contents.isEmpty()) {
         return PressureData{};
     }
 
-    qCDebug(KSYSTEMSTATS_PRESSURE) << "File open successfully";
-        
     PressureData pressureData;
 
-    for (QByteArray line = pressureInfoFile.readLine(); !line.isEmpty(); line = pressureInfoFile.readLine()) {
+    while (!contents.isEmpty()) {
+        QByteArrayView line = SourceText::takeLine(contents);
 
         qCDebug(KSYSTEMSTATS_PRESSURE) << "Reading line:" << line;
 
-        QList<QByteArray> fields = line.simplified().split(' ');
-
-        //This assumes fields is not empty, which is mostly gauranteed because
-        //we already checked if line isEmpty() in the loop
-        QByteArray type = fields.takeFirst();
-
+        const QByteArrayView type = SourceText::takeField(line);
+        if (type.isEmpty()) {
+            continue;
+        }
 
-        qCDebug(KSYSTEMSTATS_PRESSURE) << "type:" << type;
-            
         PressureDatapoint data = {0,0,0,0};
 
         // For each statistic from the fields parsed, set data based on it
-        for (QByteArray statistic : fields) {
-            const int delim = statistic.indexOf("=");
-            const QString name = statistic.left(delim).trimmed();
-            const QString value = statistic.mid(delim + 1).trimmed();
-        
-
-            qCDebug(KSYSTEMSTATS_PRESSURE) << "statistic:" << statistic << "name:" << name << "value:" << value << "processed:" << value.toDouble();
+        for (QByteArrayView statistic = SourceText::takeField(line); !statistic.isEmpty(); statistic = SourceText::takeField(line)) {
+            const qsizetype delim = statistic.indexOf('=');
+            if (delim < 0) {
+                continue;
+            }
+            const QByteArrayView name = statistic.first(delim);
+            const QByteArrayView value = statistic.sliced(delim + 1);
 
-            if (name == avg10DataLabel) {
+            if (name == "avg10") {
                 data.avg10 = value.toDouble();
-            } else if (name == avg60DataLabel) {
+            } else if (name == "avg60") {
                 data.avg60 = value.toDouble();
-            } else if (name == avg300DataLabel) {
+            } else if (name == "avg300") {
                 data.avg300 = value.toDouble();
-            } else if (name == totalDataLabel) {
+            } else if (name == "total") {
                 data.total = value.toULongLong();
             }
         }
 
-        if (type == someDataLabel) {
-            pressureData.some = data;
-        } else if (type == fullDataLabel) {
+        if (type == "full") {
             pressureData.full = data;
         } else {
             pressureData.some = data;
         }
     }
 
-    pressureInfoFile.close();
-
-
-    qCDebug(KSYSTEMSTATS_PRESSURE) << fileSelector << "some" << pressureData.some.avg10 << pressureData.some.avg60 << pressureData.some.avg300  << pressureData.some.total;
-    qCDebug(KSYSTEMSTATS_PRESSURE) << fileSelector << "full" << pressureData.full.avg10 << pressureData.full.avg60 << pressureData.full.avg300  << pressureData.full.total;
+    qCDebug(KSYSTEMSTATS_PRESSURE) << "some" << pressureData.some.avg10 << pressureData.some.avg60 << pressureData.some.avg300  << pressureData.some.total;
+    qCDebug(KSYSTEMSTATS_PRESSURE) << "full" << pressureData.full.avg10 << pressureData.full.avg60 << pressureData.full.avg300  << pressureData.full.total;
 
     return pressureData;
 }
@@ -132,6 +106,9 @@ PressurePlugin::~PressurePlugin() = default;
 /// Top level class for this plugin that implements SensorPlugin from libksysguard
 PressurePlugin::PressurePlugin(QObject *parent, const QVariantList &args)
     : SensorPlugin(parent, args)
+    , memoryFile(reads.addFile(QStringLiteral("/proc/pressure/memory")))
+    , cpuFile(reads.addFile(QStringLiteral("/proc/pressure/cpu")))
+    , ioFile(reads.addFile(QStringLiteral("/proc/pressure/io")))
 {
 
     qCDebug(KSYSTEMSTATS_PRESSURE) << "Initializing";
@@ -267,45 +244,72 @@ PressurePlugin::PressurePlugin(QObject *parent, const QVariantList &args)
     setup_totalfield(ioSomeTotalProperty);
     setup_totalfield(ioFullTotalProperty);
 
+    const std::pair<KSysGuard::SensorObject *, int> objectFiles[] = {
+        {memoryObject, memoryFile},
+        {cpuObject, cpuFile},
+        {ioObject, ioFile},
+    };
+    for (const auto &[object, file] : objectFiles) {
+        const auto properties = object->sensors();
+        for (auto property : properties) {
+            sources.addProperty(file, property);
+        }
+    }
 }
 
 void PressurePlugin::update()
 {
 
     qCDebug(KSYSTEMSTATS_PRESSURE) << "Updating";
-        
-    PressureData data = parseDataFromFile(QStringLiteral("memory"));
-
-    memorySome10SecProperty->setValue(data.some.avg10);
-    memorySome60SecProperty->setValue(data.some.avg60);
-    memorySome300SecProperty->setValue(data.some.avg300);
-    memorySomeTotalProperty->setValue(data.some.total);
-    memoryFull10SecProperty->setValue(data.full.avg10);
-    memoryFull60SecProperty->setValue(data.full.avg60);
-    memoryFull300SecProperty->setValue(data.full.avg300);
-    memoryFullTotalProperty->setValue(data.full.total);
-
-    data = parseDataFromFile(QStringLiteral("cpu"));
-    
-    cpuSome10SecProperty->setValue(data.some.avg10);
-    cpuSome60SecProperty->setValue(data.some.avg60);
-    cpuSome300SecProperty->setValue(data.some.avg300);
-    cpuSomeTotalProperty->setValue(data.some.total);
-    cpuFull10SecProperty->setValue(data.full.avg10);
-    cpuFull60SecProperty->setValue(data.full.avg60);
-    cpuFull300SecProperty->setValue(data.full.avg300);
-    cpuFullTotalProperty->setValue(data.full.total);
-
-    data = parseDataFromFile(QStringLiteral("io"));
-
-    ioSome10SecProperty->setValue(data.some.avg10);
-    ioSome60SecProperty->setValue(data.some.avg60);
-    ioSome300SecProperty->setValue(data.some.avg300);
-    ioSomeTotalProperty->setValue(data.some.total);
-    ioFull10SecProperty->setValue(data.full.avg10);
-    ioFull60SecProperty->setValue(data.full.avg60);
-    ioFull300SecProperty->setValue(data.full.avg300);
-    ioFullTotalProperty->setValue(data.full.total);
+
+    if (!sources.isAnyNeeded()) {
+        return;
+    }
+    for (int file : {memoryFile, cpuFile, ioFile}) {
+        if (file >= 0) {
+            reads.setActive(file, sources.isNeeded(file));
+        }
+    }
+    reads.submit();
+
+    if (sources.isNeeded(memoryFile)) {
+        const PressureData data = parseData(reads.data(memoryFile));
+
+        memorySome10SecProperty->setValue(data.some.avg10);
+        memorySome60SecProperty->setValue(data.some.avg60);
+        memorySome300SecProperty->setValue(data.some.avg300);
+        memorySomeTotalProperty->setValue(data.some.total);
+        memoryFull10SecProperty->setValue(data.full.avg10);
+        memoryFull60SecProperty->setValue(data.full.avg60);
+        memoryFull300SecProperty->setValue(data.full.avg300);
+        memoryFullTotalProperty->setValue(data.full.total);
+    }
+
+    if (sources.isNeeded(cpuFile)) {
+        const PressureData data = parseData(reads.data(cpuFile));
+
+        cpuSome10SecProperty->setValue(data.some.avg10);
+        cpuSome60SecProperty->setValue(data.some.avg60);
+        cpuSome300SecProperty->setValue(data.some.avg300);
+        cpuSomeTotalProperty->setValue(data.some.total);
+        cpuFull10SecProperty->setValue(data.full.avg10);
+        cpuFull60SecProperty->setValue(data.full.avg60);
+        cpuFull300SecProperty->setValue(data.full.avg300);
+        cpuFullTotalProperty->setValue(data.full.total);
+    }
+
+    if (sources.isNeeded(ioFile)) {
+        const PressureData data = parseData(reads.data(ioFile));
+
+        ioSome10SecProperty->setValue(data.some.avg10);
+        ioSome60SecProperty->setValue(data.some.avg60);
+        ioSome300SecProperty->setValue(data.some.avg300);
+        ioSomeTotalProperty->setValue(data.some.total);
+        ioFull10SecProperty->setValue(data.full.avg10);
+        ioFull60SecProperty->setValue(data.full.avg60);
+        ioFull300SecProperty->setValue(data.full.avg300);
+        ioFullTotalProperty->setValue(data.full.total);
+    }
 }
 
 K_PLUGIN_CLASS_WITH_JSON(PressurePlugin, "metadata.json")
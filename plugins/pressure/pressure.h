@@ -12,6 +12,9 @@
 #include <systemstats/SensorObject.h>
 #include <systemstats/SensorProperty.h>
 
+#include "readbatch.h"
+#include "subscribedsources.h"
+
 class PressurePlugin : public KSysGuard::SensorPlugin
 {
     Q_OBJECT
@@ -29,6 +32,13 @@ public:
 private:
     PressurePlugin *q;
 
+    // The three files are read together in one batch, indices are -1 without PSI support
+    ReadBatch reads;
+    int memoryFile = -1;
+    int cpuFile = -1;
+    int ioFile = -1;
+    SubscribedSources<int> sources;
+
     KSysGuard::SensorContainer *container = nullptr;
 
     KSysGuard::SensorObject *memoryObject = nullptr;
@@ -0,0 +1,273 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "burstsampler.h"
+
+#include <algorithm>
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDateTime>
+#include <QTimer>
+
+#include <systemstats/DBusInterface.h>
+#include <systemstats/SensorPlugin.h>
+#include <systemstats/SensorProperty.h>
+
+#include "burstsampleprovider.h"
+#include "daemon.h"
+
+QDBusArgument &operator<<(QDBusArgument &argument, const BurstSample &sample)
+{
+    argument.beginStructure();
+    argument << sample.timestamp << sample.value;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, BurstSample &sample)
+{
+    argument.beginStructure();
+    argument >> sample.timestamp >> sample.value;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const BurstSamples &samples)
+{
+    argument.beginStructure();
+    argument << samples.sensorId << samples.samples;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, BurstSamples &samples)
+{
+    argument.beginStructure();
+    argument >> samples.sensorId >> samples.samples;
+    argument.endStructure();
+    return argument;
+}
+
+BurstSampler::BurstSampler(const QDBusConnection &connection, QObject *parent)
+    : QObject(parent)
+    , m_connection(connection)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &BurstSampler::sample);
+}
+
+BurstSampler::~BurstSampler()
+{
+    for (auto &[id, burst] : m_bursts) {
+        release(burst);
+    }
+}
+
+uint BurstSampler::start(const QString &owner,
+                         const QList<KSysGuard::SensorProperty *> &sensors,
+                         std::chrono::milliseconds interval,
+                         std::chrono::milliseconds duration)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    Burst burst;
+    burst.owner = owner;
+    burst.interval = std::max(interval, MinimumInterval);
+    burst.nextSample = now;
+    burst.end = now + std::min(duration, MaximumDuration);
+    // Samples are delivered with every frame, but the frame rate is not known here, so
+    // reserve enough for the whole burst to never allocate while sampling.
+    burst.capacity = std::min(duration, MaximumDuration) / burst.interval + 1;
+    burst.batch.reserve(sensors.size());
+    for (auto sensor : sensors) {
+        sensor->subscribe();
+        burst.sensors.append(sensor);
+        BurstSamples samples{sensor->path(), {}};
+        samples.samples.reserve(burst.capacity);
+        burst.batch.append(samples);
+    }
+
+    const uint id = m_nextId++;
+    m_bursts.emplace(id, std::move(burst));
+    updateTimer();
+    return id;
+}
+
+bool BurstSampler::stop(const QString &owner, uint id)
+{
+    auto it = m_bursts.find(id);
+    if (it == m_bursts.end() || it->second.owner != owner) {
+        return false;
+    }
+    // Delivered with the next frame
+    it->second.end = std::chrono::steady_clock::now();
+    updateTimer();
+    return true;
+}
+
+void BurstSampler::removeOwner(const QString &owner)
+{
+    for (auto it = m_bursts.begin(); it != m_bursts.end();) {
+        if (it->second.owner == owner) {
+            release(it->second);
+            it = m_bursts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    updateTimer();
+}
+
+int BurstSampler::burstCount(const QString &owner) const
+{
+    return std::count_if(m_bursts.cbegin(), m_bursts.cend(), [&owner](const auto &entry) {
+        return entry.second.owner == owner;
+    });
+}
+
+void BurstSampler::replaceSensor(KSysGuard::SensorProperty *sensor)
+{
+    const QString path = sensor->path();
+    const auto now = std::chrono::steady_clock::now();
+    for (auto &[id, burst] : m_bursts) {
+        if (now >= burst.end) {
+            continue;
+        }
+        for (qsizetype i = 0; i < burst.sensors.size(); ++i) {
+            auto &current = burst.sensors[i];
+            if (burst.batch.at(i).sensorId != path || current == sensor) {
+                continue;
+            }
+            if (current) {
+                current->unsubscribe();
+            }
+            sensor->subscribe();
+            current = sensor;
+        }
+    }
+}
+
+void BurstSampler::sample()
+{
+    const auto now = std::chrono::steady_clock::now();
+    auto isDue = [now](const Burst &burst) {
+        return burst.nextSample <= now && now < burst.end;
+    };
+
+    // Update every provider only once, even if it is part of several bursts
+    m_providers.clear();
+    for (const auto &[id, burst] : m_bursts) {
+        if (!isDue(burst)) {
+            continue;
+        }
+        for (const auto &sensor : burst.sensors) {
+            auto provider = sensor ? Daemon::providerOf(sensor) : nullptr;
+            if (provider && std::find(m_providers.cbegin(), m_providers.cend(), provider) == m_providers.cend()) {
+                m_providers.push_back(provider);
+            }
+        }
+    }
+    for (auto provider : m_providers) {
+        // Daemon::startBurst() only accepts sensors of these
+        if (auto burstProvider = qobject_cast<BurstSampleProvider *>(provider)) {
+            burstProvider->sampleBurst();
+        }
+    }
+
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+    for (auto &[id, burst] : m_bursts) {
+        if (!isDue(burst)) {
+            continue;
+        }
+        for (qsizetype i = 0; i < burst.sensors.size(); ++i) {
+            const auto &sensor = burst.sensors.at(i);
+            auto &samples = burst.batch[i].samples;
+            if (!sensor || samples.size() >= burst.capacity) {
+                continue;
+            }
+            bool ok = false;
+            const double value = sensor->value().toDouble(&ok);
+            if (ok) {
+                samples.append(BurstSample{timestamp, value});
+            }
+        }
+        // Skip samples that were missed instead of catching up with them
+        burst.nextSample = std::max(burst.nextSample + burst.interval, now);
+    }
+
+    updateTimer();
+}
+
+void BurstSampler::deliver()
+{
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = m_bursts.begin(); it != m_bursts.end();) {
+        auto &burst = it->second;
+        const bool finished = now >= burst.end;
+
+        BurstSamplesList batch;
+        for (const auto &samples : std::as_const(burst.batch)) {
+            if (!samples.samples.isEmpty()) {
+                batch.append(samples);
+            }
+        }
+
+        if (!batch.isEmpty() || finished) {
+            auto msg = QDBusMessage::createTargetedSignal(burst.owner,
+                                                          KSysGuard::SystemStats::ObjectPath,
+                                                          Daemon::ControlInterface,
+                                                          QStringLiteral("burstSamples"));
+            msg.setArguments({it->first, QVariant::fromValue(batch), finished});
+            m_connection.send(msg);
+        }
+
+        if (finished) {
+            release(burst);
+            it = m_bursts.erase(it);
+            continue;
+        }
+
+        batch.clear();
+        for (auto &samples : burst.batch) {
+            // Not shared anymore once the message is sent, so this keeps the capacity
+            samples.samples.clear();
+        }
+        ++it;
+    }
+    updateTimer();
+}
+
+void BurstSampler::updateTimer()
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::chrono::milliseconds interval = std::chrono::milliseconds::max();
+    for (const auto &[id, burst] : m_bursts) {
+        if (now < burst.end) {
+            interval = std::min(interval, burst.interval);
+        }
+    }
+
+    if (interval == std::chrono::milliseconds::max()) {
+        m_timer->stop();
+    } else if (!m_timer->isActive() || m_timer->intervalAsDuration() != interval) {
+        m_timer->start(interval);
+    }
+}
+
+void BurstSampler::release(Burst &burst)
+{
+    for (const auto &sensor : std::as_const(burst.sensors)) {
+        if (sensor) {
+            sensor->unsubscribe();
+        }
+    }
+    burst.sensors.clear();
+}
+
+#include "moc_burstsampler.cpp"
@@ -0,0 +1,120 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include <QDBusConnection>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QPointer>
+
+class QDBusArgument;
+class QTimer;
+
+namespace KSysGuard
+{
+    class SensorPlugin;
+    class SensorProperty;
+}
+
+struct BurstSample {
+    // Milliseconds since the epoch
+    qint64 timestamp = 0;
+    double value = 0.0;
+};
+
+/**
+ * The samples of one sensor collected during a burst since the last delivery.
+ */
+struct BurstSamples {
+    QString sensorId;
+    QList<BurstSample> samples;
+};
+using BurstSamplesList = QList<BurstSamples>;
+
+Q_DECLARE_METATYPE(BurstSample)
+Q_DECLARE_METATYPE(BurstSamples)
+Q_DECLARE_METATYPE(BurstSamplesList)
+
+QDBusArgument &operator<<(QDBusArgument &argument, const BurstSample &sample);
+const QDBusArgument &operator>>(const QDBusArgument &argument, BurstSample &sample);
+QDBusArgument &operator<<(QDBusArgument &argument, const BurstSamples &samples);
+const QDBusArgument &operator>>(const QDBusArgument &argument, BurstSamples &samples);
+
+/**
+ * Samples a set of sensors at a higher rate than the normal update rate for a
+ * limited time.
+ *
+ * Only the providers of the sensors in a burst are updated for each sample, through
+ * BurstSampleProvider so the values of subscribers are not affected. The samples are
+ * buffered and delivered to the owner of the burst together with the
+ * normal frames, so the higher rate does not cause more D-Bus traffic.
+ */
+class BurstSampler : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr std::chrono::milliseconds MinimumInterval{10};
+    static constexpr std::chrono::milliseconds MaximumDuration{60000};
+    // Memory for the samples is reserved up front, so bursts are limited per owner
+    static constexpr int MaximumBurstsPerOwner = 8;
+    static constexpr qsizetype MaximumSensorsPerBurst = 32;
+
+    explicit BurstSampler(const QDBusConnection &connection, QObject *parent = nullptr);
+    ~BurstSampler() override;
+
+    /**
+     * Starts sampling @p sensors every @p interval for @p duration.
+     * @return The id of the burst.
+     */
+    uint start(const QString &owner, const QList<KSysGuard::SensorProperty *> &sensors, std::chrono::milliseconds interval, std::chrono::milliseconds duration);
+    bool stop(const QString &owner, uint id);
+    void removeOwner(const QString &owner);
+    /**
+     * The number of bursts of @p owner, including stopped ones that were not delivered yet.
+     */
+    int burstCount(const QString &owner) const;
+
+    /**
+     * Samples @p sensor instead of an earlier sensor with the same path, like after the
+     * provider of the sensors was reloaded.
+     */
+    void replaceSensor(KSysGuard::SensorProperty *sensor);
+
+    /**
+     * Sends the samples collected since the last call to the owners of the bursts
+     * and removes bursts that are finished.
+     */
+    void deliver();
+
+private:
+    struct Burst {
+        QString owner;
+        std::chrono::milliseconds interval;
+        std::chrono::steady_clock::time_point nextSample;
+        std::chrono::steady_clock::time_point end;
+        QList<QPointer<KSysGuard::SensorProperty>> sensors;
+        // Parallel to sensors
+        BurstSamplesList batch;
+        qsizetype capacity = 0;
+    };
+
+    void sample();
+    void updateTimer();
+    static void release(Burst &burst);
+
+    QDBusConnection m_connection;
+    QTimer *m_timer;
+    std::map<uint, Burst> m_bursts;
+    uint m_nextId = 1;
+    // Reused between samples to collect the providers that need an update
+    std::vector<KSysGuard::SensorPlugin *> m_providers;
+};
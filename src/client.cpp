@@ -8,6 +8,7 @@
 
 #include <QDBusConnection>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
 
 #include <algorithm>
 
@@ -17,87 +18,369 @@
 #include <systemstats/SensorProperty.h>
 
 #include "daemon.h"
+#include "debug.h"
+#include "frametrace.h"
+
+// Every this many frames the client is pinged to check whether it still reads its messages
+constexpr int PingInterval = 4;
+// A client that did not answer a ping for this many frames is considered slow
+constexpr int MaxUnacknowledgedFrames = 10;
+
+static bool isSameInfo(const KSysGuard::SensorInfo &first, const KSysGuard::SensorInfo &second)
+{
+    return first.name == second.name && first.shortName == second.shortName && first.description == second.description
+        && first.variantType == second.variantType && first.unit == second.unit && first.min == second.min && first.max == second.max
+        && first.prefix == second.prefix;
+}
 
 Client::Client(Daemon *parent, const QString &serviceName)
     : QObject(parent)
     , m_serviceName(serviceName)
+    , m_traceName(QStringLiteral("client %1").arg(serviceName))
     , m_daemon(parent)
 {
-    connect(m_daemon, &Daemon::sensorRemoved, this, [this](const QString &sensor) {
+    connect(m_daemon, &Daemon::sensorRegistered, this, [this](KSysGuard::SensorProperty *sensor) {
+        for (const auto &[id, rule] : m_thresholdRules) {
+            if (rule->matches(sensor->path())) {
+                rule->addSensor(sensor);
+            }
+        }
+        for (auto &snapshot : m_pendingSnapshots) {
+            replaceSnapshotSensor(snapshot, sensor);
+        }
+    });
+    connect(m_daemon, &Daemon::sensorUnregistered, this, [this](const QString &sensor) {
         m_subscribedSensors.remove(sensor);
+        for (const auto &[id, rule] : m_thresholdRules) {
+            rule->removeSensor(sensor);
+        }
     });
 }
 
 Client::~Client()
 {
+    auto frameBuilder = m_daemon->frameBuilder();
+    for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it) {
+        frameBuilder->removeSensor(it.key());
+    }
     for (auto sensor : std::as_const(m_subscribedSensors)) {
         sensor->unsubscribe();
     }
+    for (const auto &snapshot : std::as_const(m_pendingSnapshots)) {
+        releaseSnapshot(snapshot);
+    }
 }
 
 void Client::subscribeSensors(const QStringList &sensorPaths)
 {
-    KSysGuard::SensorDataList entries;
-
+    auto frameBuilder = m_daemon->frameBuilder();
+    // Current values are sent right away instead of with the next frame
+    FrameValues &initialValues = frameBuilder->frameValues();
     for (const QString &sensorPath : sensorPaths) {
         if (auto sensor = m_daemon->findSensor(sensorPath)) {
-            Connections connections;
-            connections.valueChanged = connect(sensor, &KSysGuard::SensorProperty::valueChanged, this, [this, sensor]() {
-                const QVariant value = sensor->value();
-                if (!value.isValid()) {
-                    return;
+            if (m_subscriptions.contains(sensor)) {
+                continue;
+            }
+
+            Subscription subscription;
+            // Value changes are tracked by the frame builder, shared between all clients
+            subscription.index = frameBuilder->addSensor(sensor);
+            setIndexState(subscription.index, Subscribed);
+            // Clients fetch the metadata before subscribing
+            subscription.sentInfo = sensor->info();
+            subscription.infoChanged = connect(sensor, &KSysGuard::SensorProperty::sensorInfoChanged, this, [this, sensor]() {
+                // Providers set metadata again with every update, even if it did not change
+                const KSysGuard::SensorInfo info = sensor->info();
+                if (isSameInfo(info, m_subscriptions[sensor].sentInfo)) {
+                    m_pendingMetaDataChanges.remove(sensor->path());
+                } else {
+                    m_pendingMetaDataChanges[sensor->path()] = info;
                 }
-                m_pendingUpdates << KSysGuard::SensorData(sensor->path(), value);
-            });
-            connections.infoChanged = connect(sensor, &KSysGuard::SensorProperty::sensorInfoChanged, this, [this, sensor]() {
-                m_pendingMetaDataChanges[sensor->path()] = sensor->info();
             });
-            connections.destroyed = connect(sensor, &KSysGuard::SensorProperty::destroyed, this, [this, sensor]() {
+            subscription.destroyed = connect(sensor, &KSysGuard::SensorProperty::destroyed, this, [this, sensor]() {
                 m_subscribedSensors.remove(m_subscribedSensors.key(sensor));
-                m_connections.remove(sensor);
+                // The frame builder releases the index of destroyed sensors by itself
+                setIndexState(m_subscriptions.take(sensor).index, NotSubscribed);
             });
 
-            m_connections.insert(sensor, connections);
+            m_subscriptions.insert(sensor, subscription);
 
             sensor->subscribe();
 
             m_subscribedSensors.insert(sensorPath, sensor);
+            if (frameBuilder->hasValue(subscription.index)) {
+                initialValues.indices.append(subscription.index);
+            }
         }
     }
+    sendValues(initialValues);
 }
 
 void Client::unsubscribeSensors(const QStringList &sensorPaths)
 {
     for (const QString &sensorPath : sensorPaths) {
         if (auto sensor = m_subscribedSensors.take(sensorPath)) {
-            auto connections = m_connections.take(sensor);
-            disconnect(connections.valueChanged);
-            disconnect(connections.infoChanged);
-            disconnect(connections.destroyed);
+            auto subscription = m_subscriptions.take(sensor);
+            disconnect(subscription.infoChanged);
+            disconnect(subscription.destroyed);
+            setIndexState(subscription.index, NotSubscribed);
+            m_daemon->frameBuilder()->removeSensor(sensor);
+            sensor->unsubscribe();
+        }
+    }
+}
+
+QStringList Client::subscribedSensors() const
+{
+    return m_subscribedSensors.keys();
+}
+
+void Client::setIndexState(int index, IndexState state)
+{
+    if (index >= int(m_indexStates.size())) {
+        m_indexStates.resize(index + 1, NotSubscribed);
+    }
+    if (m_indexStates[index] == ValuePending) {
+        m_pendingIndices.removeOne(index);
+    }
+    m_indexStates[index] = state;
+}
+
+void Client::snapshot(const QStringList &sensorIds, const QDBusMessage &message)
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    PendingSnapshot snapshot{message, {}, {}, {}};
+    // Earlier snapshots still waiting for a frame need to be answered first
+    bool needsFrame = frameBuilder->generation() == 0 || !m_pendingSnapshots.isEmpty();
+    for (const QString &sensorId : sensorIds) {
+        auto sensor = m_daemon->findSensor(sensorId);
+        if (!sensor) {
+            continue;
+        }
+        if (frameBuilder->indexOf(sensor) < 0) {
+            frameBuilder->addSensor(sensor);
+            sensor->subscribe();
+            snapshot.trackedSensors.append(sensor);
+            needsFrame = true;
+        }
+        snapshot.sensors.append(sensor);
+        snapshot.sensorIds.append(sensorId);
+    }
+
+    if (needsFrame) {
+        m_pendingSnapshots.append(snapshot);
+    } else {
+        sendSnapshot(snapshot);
+    }
+}
+
+void Client::sendSnapshot(const PendingSnapshot &snapshot)
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    FrameValues &values = frameBuilder->frameValues();
+    for (const auto &sensor : snapshot.sensors) {
+        const int index = sensor ? frameBuilder->indexOf(sensor) : -1;
+        if (index >= 0 && frameBuilder->hasValue(index)) {
+            values.indices.append(index);
+        }
+    }
+
+    const auto reply = snapshot.message.createReply({
+        QVariant::fromValue(values),
+        QVariant::fromValue(frameBuilder->generation()),
+        QVariant::fromValue(frameBuilder->timestamp()),
+    });
+    m_daemon->connection().send(reply);
+}
+
+void Client::releaseSnapshot(const PendingSnapshot &snapshot)
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    for (const auto &sensor : snapshot.trackedSensors) {
+        if (sensor) {
+            frameBuilder->removeSensor(sensor);
             sensor->unsubscribe();
         }
     }
 }
 
+void Client::replaceSnapshotSensor(PendingSnapshot &snapshot, KSysGuard::SensorProperty *sensor)
+{
+    const auto index = snapshot.sensorIds.indexOf(sensor->path());
+    if (index < 0 || snapshot.sensors.at(index) == sensor) {
+        return;
+    }
+    snapshot.sensors[index] = sensor;
+    auto frameBuilder = m_daemon->frameBuilder();
+    if (frameBuilder->indexOf(sensor) < 0) {
+        frameBuilder->addSensor(sensor);
+        sensor->subscribe();
+        snapshot.trackedSensors.append(sensor);
+    }
+}
+
 void Client::sendFrame()
 {
+    FrameTrace::Span span(m_daemon->frameTrace(), m_traceName);
+    evaluateThresholds();
+
+    // Not subject to slow client handling, the caller is blocked on the reply
+    for (const auto &snapshot : std::as_const(m_pendingSnapshots)) {
+        sendSnapshot(snapshot);
+    }
+    // Only once all were sent, later snapshots may rely on sensors tracked for earlier ones
+    for (const auto &snapshot : std::as_const(m_pendingSnapshots)) {
+        releaseSnapshot(snapshot);
+    }
+    m_pendingSnapshots.clear();
+
+    collectChanges();
+
+    ++m_unacknowledgedFrames;
+    if (!m_pingPending && m_unacknowledgedFrames >= PingInterval) {
+        sendPing();
+    }
+
+    if (!m_slow && m_unacknowledgedFrames > MaxUnacknowledgedFrames) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Client" << m_serviceName << "is not keeping up, holding back frames";
+        m_slow = true;
+    }
+
+    if (m_slow) {
+        // Pending updates are per sensor, so holding back frames does not grow memory usage.
+        if (!m_pendingIndices.isEmpty() || !m_pendingMetaDataChanges.isEmpty()) {
+            ++m_droppedFrames;
+        }
+        return;
+    }
+
     sendMetaDataChanged(m_pendingMetaDataChanges);
-    sendValues(m_pendingUpdates);
-    m_pendingUpdates.clear();
+    for (auto it = m_pendingMetaDataChanges.cbegin(); it != m_pendingMetaDataChanges.cend(); ++it) {
+        if (auto sensor = m_subscribedSensors.value(it.key())) {
+            m_subscriptions[sensor].sentInfo = it.value();
+        }
+    }
     m_pendingMetaDataChanges.clear();
+
+    sendValues(takePendingValues());
+}
+
+void Client::collectChanges()
+{
+    // Only remember which sensors changed, the values are read when the frame is sent.
+    // That way a client that is not keeping up only ever gets the latest values.
+    const auto &changed = m_daemon->frameBuilder()->changedSensors();
+    for (int index : changed) {
+        if (index < int(m_indexStates.size()) && m_indexStates[index] == Subscribed) {
+            m_indexStates[index] = ValuePending;
+            m_pendingIndices.append(index);
+        }
+    }
+}
+
+FrameValues &Client::takePendingValues()
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    FrameValues &values = frameBuilder->frameValues();
+    for (int index : std::as_const(m_pendingIndices)) {
+        m_indexStates[index] = Subscribed;
+        if (frameBuilder->hasValue(index)) {
+            values.indices.append(index);
+        }
+    }
+    m_pendingIndices.clear();
+    return values;
+}
+
+bool Client::isSlow() const
+{
+    return m_slow;
+}
+
+quint64 Client::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+uint Client::addThresholdRule(std::unique_ptr<ThresholdRule> rule)
+{
+    const auto sensors = m_daemon->sensorProperties();
+    for (auto sensor : sensors) {
+        if (rule->matches(sensor->path())) {
+            rule->addSensor(sensor);
+        }
+    }
+
+    const uint id = m_nextThresholdRuleId++;
+    m_thresholdRules.emplace(id, std::move(rule));
+    return id;
+}
+
+bool Client::removeThresholdRule(uint id)
+{
+    return m_thresholdRules.erase(id) > 0;
+}
+
+int Client::thresholdRuleCount() const
+{
+    return int(m_thresholdRules.size());
+}
+
+void Client::evaluateThresholds()
+{
+    if (m_thresholdRules.empty()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto &[id, rule] : m_thresholdRules) {
+        const auto transitions = rule->evaluate(now);
+        for (const auto &transition : transitions) {
+            // Not subject to slow client handling, transitions are rare and must not get lost
+            auto msg = QDBusMessage::createTargetedSignal(m_serviceName,
+                                                          KSysGuard::SystemStats::ObjectPath,
+                                                          Daemon::ControlInterface,
+                                                          QStringLiteral("thresholdStateChanged"));
+            msg.setArguments({id, transition.sensorPath, transition.active, transition.value});
+            m_daemon->connection().send(msg);
+        }
+    }
+}
+
+void Client::sendPing()
+{
+    // Every D-Bus connection implements org.freedesktop.DBus.Peer, a client that does not
+    // read from its socket will not answer though.
+    auto msg = QDBusMessage::createMethodCall(m_serviceName, QStringLiteral("/"), QStringLiteral("org.freedesktop.DBus.Peer"), QStringLiteral("Ping"));
+    auto watcher = new QDBusPendingCallWatcher(m_daemon->connection().asyncCall(msg), this);
+    m_pingPending = true;
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        m_pingPending = false;
+        if (watcher->isError()) {
+            return;
+        }
+        m_unacknowledgedFrames = 0;
+        if (m_slow) {
+            qCDebug(KSYSTEMSTATS_DAEMON) << "Client" << m_serviceName << "caught up after" << m_droppedFrames << "dropped frames";
+            m_slow = false;
+        }
+    });
 }
 
-void Client::sendValues(const KSysGuard::SensorDataList &entries)
+void Client::sendValues(const FrameValues &values)
 {
-    if (entries.isEmpty()) {
+    if (values.indices.isEmpty()) {
         return;
     }
     auto msg = QDBusMessage::createTargetedSignal(m_serviceName,
                                                   KSysGuard::SystemStats::ObjectPath,
                                                   KSysGuard::SystemStats::DBusInterface::staticInterfaceName(),
                                                   "newSensorData");
-    msg.setArguments({QVariant::fromValue(entries)});
-    QDBusConnection::sessionBus().send(msg);
+    // Marshalled while sending, directly from the values stored in the frame builder
+    msg.setArguments({QVariant::fromValue(values)});
+    FrameTrace::Span span(m_daemon->frameTrace(), QStringLiteral("send newSensorData"));
+    m_daemon->connection().send(msg);
 }
 
 void Client::sendMetaDataChanged(const KSysGuard::SensorInfoMap &sensors)
@@ -110,7 +393,8 @@ void Client::sendMetaDataChanged(const KSysGuard::SensorInfoMap &sensors)
                                                   KSysGuard::SystemStats::DBusInterface::staticInterfaceName(),
                                                   "sensorMetaDataChanged");
     msg.setArguments({QVariant::fromValue(sensors)});
-    QDBusConnection::sessionBus().send(msg);
+    FrameTrace::Span span(m_daemon->frameTrace(), QStringLiteral("send sensorMetaDataChanged"));
+    m_daemon->connection().send(msg);
 }
 
 #include "moc_client.cpp"
@@ -6,10 +6,19 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QDBusMessage>
 #include <QObject>
+#include <QPointer>
 
 #include <systemstats/SensorInfo.h>
 
+#include "framebuilder.h"
+#include "thresholdrule.h"
+
 namespace KSysGuard
 {
     class SensorProperty;
@@ -27,22 +36,102 @@ public:
     ~Client() override;
     void subscribeSensors(const QStringList &sensorIds);
     void unsubscribeSensors(const QStringList &sensorIds);
+    QStringList subscribedSensors() const;
     void sendFrame();
 
+    /**
+     * Marks the subscribed sensors that changed in the current frame as pending.
+     * Part of sendFrame(), which calls this for every frame, also while the client is slow.
+     */
+    void collectChanges();
+    /**
+     * The values of the pending sensors, which are no longer pending afterwards.
+     * Part of sendFrame(), which only sends them while the client keeps up.
+     */
+    FrameValues &takePendingValues();
+
+    /**
+     * Whether this client is currently considered to not keep up with the
+     * frames we send. While slow, frames are not sent but only the latest
+     * value of each changed sensor is kept.
+     */
+    bool isSlow() const;
+    /**
+     * The number of frames that were not sent to this client because it was slow.
+     */
+    quint64 droppedFrames() const;
+
+    // Every rule is evaluated with every frame, and clients of the system instance are any local user
+    static constexpr int MaximumThresholdRules = 64;
+
+    /**
+     * Adds a threshold rule owned by this client.
+     * @return The id of the rule, used to identify it in thresholdStateChanged.
+     */
+    uint addThresholdRule(std::unique_ptr<ThresholdRule> rule);
+    bool removeThresholdRule(uint id);
+    int thresholdRuleCount() const;
+
+    /**
+     * Replies to @p message with the values of @p sensorIds, all taken from the same frame.
+     * Sensors that are not part of a frame yet are tracked from now on and the reply is
+     * sent once the next frame was built.
+     */
+    void snapshot(const QStringList &sensorIds, const QDBusMessage &message);
+
 private:
-    struct Connections {
-        QMetaObject::Connection valueChanged;
+    struct Subscription {
+        // Index of the sensor in the daemon's FrameBuilder
+        int index = -1;
+        // The metadata the client knows about, to only send actual changes
+        KSysGuard::SensorInfo sentInfo;
         QMetaObject::Connection infoChanged;
         QMetaObject::Connection destroyed;
     };
 
-    void sendValues(const KSysGuard::SensorDataList &updates);
+    enum IndexState : quint8 {
+        NotSubscribed,
+        Subscribed,
+        ValuePending,
+    };
+
+    struct PendingSnapshot {
+        QDBusMessage message;
+        QList<QPointer<KSysGuard::SensorProperty>> sensors;
+        // Parallel to sensors, to find them again if their provider is reloaded before the reply
+        QStringList sensorIds;
+        // Added to the frame builder only for this snapshot, released once it was sent
+        QList<QPointer<KSysGuard::SensorProperty>> trackedSensors;
+    };
+
+    void setIndexState(int index, IndexState state);
+    void sendSnapshot(const PendingSnapshot &snapshot);
+    void releaseSnapshot(const PendingSnapshot &snapshot);
+    void replaceSnapshotSensor(PendingSnapshot &snapshot, KSysGuard::SensorProperty *sensor);
+    void sendValues(const FrameValues &values);
     void sendMetaDataChanged(const KSysGuard::SensorInfoMap &sensors);
+    void sendPing();
+    void evaluateThresholds();
 
     const QString m_serviceName;
+    // Name of the sendFrame() trace point, see FrameTrace
+    const QString m_traceName;
     Daemon *m_daemon;
     QHash<QString, KSysGuard::SensorProperty *> m_subscribedSensors;
-    QHash<KSysGuard::SensorProperty *, Connections> m_connections;
-    KSysGuard::SensorDataList m_pendingUpdates;
+    QHash<KSysGuard::SensorProperty *, Subscription> m_subscriptions;
+    // Per FrameBuilder index, so checking the changes of a frame needs no lookups
+    std::vector<IndexState> m_indexStates;
+    // Sensors that changed since the last frame was sent, each listed at most once
+    QList<int> m_pendingIndices;
     KSysGuard::SensorInfoMap m_pendingMetaDataChanges;
+
+    bool m_pingPending = false;
+    bool m_slow = false;
+    int m_unacknowledgedFrames = 0;
+    quint64 m_droppedFrames = 0;
+
+    QList<PendingSnapshot> m_pendingSnapshots;
+
+    std::map<uint, std::unique_ptr<ThresholdRule>> m_thresholdRules;
+    uint m_nextThresholdRuleId = 1;
 };
@@ -9,10 +9,16 @@
 
 #include <algorithm>
 #include <chrono>
+#include <utility>
+
+#include <unistd.h>
 
 #include <QDBusConnection>
 #include <QDBusMetaType>
 #include <QDBusServiceWatcher>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QStandardPaths>
 
 #include <QTimer>
 
@@ -29,17 +35,46 @@
 #include <sensors/sensors.h>
 #endif
 
+#include "asyncupdateprovider.h"
+#include "burstsampleprovider.h"
+#include "controladaptor.h"
 #include "ksystemstats1adaptor.h"
 
+#include "burstsampler.h"
 #include "client.h"
 #include "debug.h"
+#include "derivedsensors.h"
+#include "framebuilder.h"
+#include "frametrace.h"
+#include "socketserver.h"
+#include "valuetable.h"
 
 using namespace Qt::StringLiterals;
 
 constexpr auto UpdateRate = std::chrono::milliseconds{500};
+constexpr auto MinimumUpdateRate = std::chrono::milliseconds{50};
+// After this many updates in a row over budget a provider is updated less often
+constexpr int MaximumConsecutiveOverruns = 3;
+// After this many updates in a row within budget a throttled provider is updated more often again
+constexpr int RecoveryUpdates = 10;
+// Throttled providers are still updated at least this often
+constexpr auto MaximumThrottledInterval = std::chrono::milliseconds{8000};
+// How long a frame waits for asynchronous updates at most
+constexpr auto AsyncUpdateDeadline = std::chrono::milliseconds{100};
+// After this long an asynchronous update is considered hanging and a new one is started
+constexpr auto AsyncUpdateTimeout = std::chrono::seconds{2};
+// How long sensors of a reloaded provider may take to appear again before clients are told they are gone
+constexpr auto ReloadGracePeriod = std::chrono::seconds{10};
 
-Daemon::Daemon()
-    : m_serviceWatcher(new QDBusServiceWatcher(this))
+Daemon::Daemon(const QDBusConnection &connection)
+    : m_connection(connection)
+    , m_config(KSharedConfig::openConfig(u"ksystemstatsrc"_s))
+    , m_updateTimer(new QTimer(this))
+    , m_frameDeadline(new QTimer(this))
+    , m_reloadTimer(new QTimer(this))
+    , m_frameBuilder(new FrameBuilder(this))
+    , m_burstSampler(new BurstSampler(connection, this))
+    , m_serviceWatcher(new QDBusServiceWatcher(this))
 {
     qDBusRegisterMetaType<KSysGuard::SensorData>();
     qDBusRegisterMetaType<KSysGuard::SensorInfo>();
@@ -47,20 +82,42 @@ Daemon::Daemon()
     qDBusRegisterMetaType<KSysGuard::SensorDataList>();
     qDBusRegisterMetaType<KSysGuard::SensorInfoMap>();
     qDBusRegisterMetaType<QStringList>();
+    qDBusRegisterMetaType<FrameValues>();
+    qDBusRegisterMetaType<BurstSample>();
+    qDBusRegisterMetaType<BurstSamples>();
+    qDBusRegisterMetaType<BurstSamplesList>();
 
     new Ksystemstats1Adaptor(this);
+    new ControlAdaptor(this);
 
-    m_serviceWatcher->setConnection(QDBusConnection::sessionBus());
+    m_serviceWatcher->setConnection(m_connection);
     connect(m_serviceWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &Daemon::onServiceDisconnected);
 
-    auto timer = new QTimer(this);
-    timer->setInterval(UpdateRate);
-    connect(timer, &QTimer::timeout, this, &Daemon::sendFrame);
-    timer->start();
+    const auto interval = std::chrono::milliseconds{m_config->group(u"General"_s).readEntry("UpdateInterval", qint64(UpdateRate.count()))};
+    m_updateTimer->setInterval(std::max(interval, MinimumUpdateRate));
+    connect(m_updateTimer, &QTimer::timeout, this, &Daemon::sendFrame);
+    m_updateTimer->start();
+
+    m_frameDeadline->setSingleShot(true);
+    m_frameDeadline->setInterval(std::min(AsyncUpdateDeadline, m_updateTimer->intervalAsDuration() / 2));
+    connect(m_frameDeadline, &QTimer::timeout, this, &Daemon::finishFrame);
+
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(ReloadGracePeriod);
+    connect(m_reloadTimer, &QTimer::timeout, this, &Daemon::finishReload);
+
+    connect(this, &Daemon::sensorRegistered, m_burstSampler, &BurstSampler::replaceSensor);
+
+    if (m_config->group(u"Tracing"_s).readEntry("Enabled", false)) {
+        createFrameTrace();
+    }
 }
 
 Daemon::~Daemon()
 {
+    // Release their sensors from the frame builder
+    delete m_valueTable;
+    delete m_socketServer;
     for (Client* c : m_clients) {
         delete c;
     }
@@ -75,8 +132,10 @@ bool Daemon::init(ReplaceIfRunning replaceIfRunning)
     sensors_init(nullptr);
 #endif
     loadProviders();
+    createValueTable();
+    createSocketServer();
 
-    QDBusConnection::sessionBus().registerObject(KSysGuard::SystemStats::ObjectPath, this, QDBusConnection::ExportAdaptors);
+    m_connection.registerObject(KSysGuard::SystemStats::ObjectPath, this, QDBusConnection::ExportAdaptors);
 
     if (!registerDBusService(KSysGuard::SystemStats::ServiceName, replaceIfRunning)) {
         return false;
@@ -85,26 +144,189 @@ bool Daemon::init(ReplaceIfRunning replaceIfRunning)
     return true;
 }
 
+QDBusConnection Daemon::connection() const
+{
+    return m_connection;
+}
+
 void Daemon::setQuitOnLastClientDisconnect(bool quit)
 {
     m_quitOnLastClientDisconnect = quit;
 }
 
+void Daemon::createValueTable()
+{
+    const KConfigGroup config = m_config->group(u"ValueTable"_s);
+    const QStringList patterns = config.readEntry("Sensors", QStringList{});
+    if (patterns.isEmpty()) {
+        return;
+    }
+
+    const uint capacity = config.readEntry("Capacity", ValueTable::DefaultCapacity);
+    m_valueTable = new ValueTable(m_frameBuilder, patterns, capacity, this);
+    if (!m_valueTable->open(config.readEntry("Name", u"/ksystemstats-%1"_s.arg(getuid())))) {
+        delete m_valueTable;
+        m_valueTable = nullptr;
+        return;
+    }
+
+    const auto sensors = sensorProperties();
+    for (auto sensor : sensors) {
+        m_valueTable->addSensor(sensor);
+    }
+    connect(this, &Daemon::sensorRegistered, m_valueTable, &ValueTable::addSensor);
+}
+
+void Daemon::createFrameTrace()
+{
+    const uint capacity = m_config->group(u"Tracing"_s).readEntry("Capacity", FrameTrace::DefaultCapacity);
+    m_frameTrace = std::make_unique<FrameTrace>(capacity);
+    m_frameTrace->setEnabled(true);
+}
+
+FrameTrace *Daemon::frameTrace() const
+{
+    return m_frameTrace.get();
+}
+
+void Daemon::createSocketServer()
+{
+    const KConfigGroup config = m_config->group(u"Socket"_s);
+    if (!config.readEntry("Enabled", false)) {
+        return;
+    }
+
+    const QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation) + u"/ksystemstats"_s;
+    m_socketServer = new SocketServer(this);
+    if (!m_socketServer->listen(config.readEntry("Path", defaultPath), config.readEntry("AllowAllUsers", false))) {
+        delete m_socketServer;
+        m_socketServer = nullptr;
+    }
+}
+
 void Daemon::loadProviders()
 {
-    const QList<KPluginMetaData> plugins = KPluginMetaData::findPlugins(QStringLiteral("ksystemstats"));
+    const auto plugins = KPluginMetaData::findPlugins(QStringLiteral("ksystemstats"));
     if (plugins.isEmpty()) {
         qCWarning(KSYSTEMSTATS_DAEMON) << "No plugins found";
     }
     for (const KPluginMetaData &metaData : plugins) {
-        auto provider = KPluginFactory::instantiatePlugin<KSysGuard::SensorPlugin>(metaData);
-        if (!provider.plugin) {
-            qCWarning(KSYSTEMSTATS_DAEMON) << "Could not load plugin:" << metaData.pluginId() << "with file name" << metaData.fileName();
-        } else {
-            registerProvider(provider.plugin);
-            qCDebug(KSYSTEMSTATS_DAEMON) << "Loaded plugin" << metaData.pluginId() << "from file" << metaData.fileName();
+        addPlugin(metaData);
+    }
+}
+
+void Daemon::addPlugin(const KPluginMetaData &metaData)
+{
+    m_plugins.append(metaData);
+    if (!metaData.isEnabled(pluginsConfig())) {
+        qCDebug(KSYSTEMSTATS_DAEMON) << "Plugin" << metaData.pluginId() << "is disabled";
+        return;
+    }
+    loadPlugin(metaData);
+}
+
+KSysGuard::SensorPlugin *Daemon::instantiatePlugin(const KPluginMetaData &metaData)
+{
+    return KPluginFactory::instantiatePlugin<KSysGuard::SensorPlugin>(metaData).plugin;
+}
+
+bool Daemon::loadPlugin(const KPluginMetaData &metaData)
+{
+    auto provider = instantiatePlugin(metaData);
+    if (!provider) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Could not load plugin:" << metaData.pluginId() << "with file name" << metaData.fileName();
+        return false;
+    }
+    registerProvider(provider);
+    if (!m_providers.contains(provider)) {
+        return false;
+    }
+
+    auto &state = m_providerStates[provider];
+    state.pluginId = metaData.pluginId();
+    const KConfigGroup config = pluginsConfig().group(state.pluginId);
+    state.updateInterval = std::chrono::milliseconds{config.readEntry("UpdateInterval", 0)};
+    state.updateBudget = std::chrono::milliseconds{config.readEntry("UpdateBudget", qint64(DefaultUpdateBudget.count()))};
+    qCDebug(KSYSTEMSTATS_DAEMON) << "Loaded plugin" << metaData.pluginId() << "from file" << metaData.fileName();
+    return true;
+}
+
+void Daemon::unloadProvider(KSysGuard::SensorPlugin *provider)
+{
+    const auto containers = provider->containers();
+    for (auto container : containers) {
+        m_containers.remove(container->id());
+        const auto objects = container->objects();
+        for (auto object : objects) {
+            notifySensorsRemoved(object);
+        }
+    }
+    m_providers.removeOne(provider);
+    m_providerStates.remove(provider);
+    m_awaitedUpdates.remove(provider);
+    // Clients, frames and rules drop their references once the sensors are destroyed
+    delete provider;
+    m_metaDataStore.prune();
+}
+
+void Daemon::scheduleMetaDataPrune()
+{
+    // Objects are only destroyed after they were removed
+    if (!std::exchange(m_metaDataPrunePending, true)) {
+        QTimer::singleShot(0, this, [this]() {
+            m_metaDataPrunePending = false;
+            m_metaDataStore.prune();
+        });
+    }
+}
+
+KSysGuard::SensorPlugin *Daemon::providerForPlugin(const QString &pluginId) const
+{
+    for (auto it = m_providerStates.cbegin(); it != m_providerStates.cend(); ++it) {
+        if (it->pluginId == pluginId) {
+            return it.key();
         }
     }
+    return nullptr;
+}
+
+void Daemon::updateWatchdog(KSysGuard::SensorPlugin *provider, ProviderState &state, std::chrono::steady_clock::duration duration)
+{
+    using namespace std::chrono;
+
+    state.lastUpdateDuration = duration_cast<microseconds>(duration);
+    if (duration <= state.updateBudget) {
+        state.consecutiveOverruns = 0;
+        if (state.throttledInterval.count() > 0 && ++state.consecutiveUpdatesInBudget >= RecoveryUpdates) {
+            state.consecutiveUpdatesInBudget = 0;
+            state.throttledInterval /= 2;
+            if (state.throttledInterval <= m_updateTimer->intervalAsDuration()) {
+                state.throttledInterval = milliseconds{0};
+            }
+            qCDebug(KSYSTEMSTATS_DAEMON) << "Provider" << provider->providerName() << "is within its update budget again, interval is now"
+                                         << state.throttledInterval;
+        }
+        return;
+    }
+
+    ++state.overruns;
+    state.consecutiveUpdatesInBudget = 0;
+    if (++state.consecutiveOverruns < MaximumConsecutiveOverruns || state.throttledInterval >= MaximumThrottledInterval) {
+        return;
+    }
+
+    // Update the provider less often so it does not delay every frame
+    state.consecutiveOverruns = 0;
+    const auto frameInterval = duration_cast<milliseconds>(m_updateTimer->intervalAsDuration());
+    state.throttledInterval = std::min(std::max(state.throttledInterval, frameInterval) * 2, MaximumThrottledInterval);
+    qCWarning(KSYSTEMSTATS_DAEMON) << "Provider" << provider->providerName() << "took" << duration_cast<milliseconds>(duration)
+                                   << "to update, exceeding its budget of" << state.updateBudget << "- updating it only every"
+                                   << state.throttledInterval;
+}
+
+KConfigGroup Daemon::pluginsConfig() const
+{
+    return m_config->group(u"Plugins"_s);
 }
 
 void Daemon::registerProvider(KSysGuard::SensorPlugin *provider) {
@@ -116,22 +338,71 @@ void Daemon::registerProvider(KSysGuard::SensorPlugin *provider) {
         return;
     }
     m_providers.append(provider);
+    auto &state = m_providerStates[provider];
+    state.traceName = u"update %1"_s.arg(provider->providerName());
+    registerContainers(provider);
+}
+
+void Daemon::registerContainers(KSysGuard::SensorPlugin *provider)
+{
     const auto containers = provider->containers();
     for (auto container : containers) {
         m_containers[container->id()] = container;
+        // Only relevant for providers loaded at runtime, there are no clients while loading the initial ones
+        const auto objects = container->objects();
+        for (auto object : objects) {
+            m_metaDataStore.add(object);
+            m_sensorIndex.add(object);
+            notifySensorsAdded(object);
+        }
         connect(container, &KSysGuard::SensorContainer::objectAdded, this, [this](KSysGuard::SensorObject *obj) {
-            for (auto sensor: obj->sensors()) {
-                emit sensorAdded(sensor->path());
-            }
+            m_metaDataStore.add(obj);
+            m_sensorIndex.add(obj);
+            notifySensorsAdded(obj);
         });
         connect(container, &KSysGuard::SensorContainer::objectRemoved, this, [this](KSysGuard::SensorObject *obj) {
-            for (auto sensor: obj->sensors()) {
-                emit sensorRemoved(sensor->path());
-            }
+            m_sensorIndex.remove(obj);
+            notifySensorsRemoved(obj);
+            scheduleMetaDataPrune();
         });
     }
 }
 
+void Daemon::notifySensorsAdded(KSysGuard::SensorObject *object)
+{
+    // Subscriptions to sensors of a reloaded provider are moved to the new sensors with the same path
+    QHash<Client *, QStringList> subscriptions;
+    const auto sensors = object->sensors();
+    for (auto sensor : sensors) {
+        Q_EMIT sensorRegistered(sensor);
+        auto reloaded = m_reloadedSensors.find(sensor->path());
+        if (reloaded == m_reloadedSensors.end()) {
+            Q_EMIT sensorAdded(sensor->path());
+            continue;
+        }
+        for (const auto &client : std::as_const(*reloaded)) {
+            if (client) {
+                subscriptions[client].append(sensor->path());
+            }
+        }
+        m_reloadedSensors.erase(reloaded);
+    }
+    for (auto it = subscriptions.cbegin(); it != subscriptions.cend(); ++it) {
+        it.key()->subscribeSensors(it.value());
+    }
+}
+
+void Daemon::notifySensorsRemoved(KSysGuard::SensorObject *object)
+{
+    const auto sensors = object->sensors();
+    for (auto sensor : sensors) {
+        Q_EMIT sensorUnregistered(sensor->path());
+        if (!m_reloadedSensors.contains(sensor->path())) {
+            Q_EMIT sensorRemoved(sensor->path());
+        }
+    }
+}
+
 KSysGuard::SensorInfoMap Daemon::allSensors() const
 {
     KSysGuard::SensorInfoMap infoMap;
@@ -166,7 +437,7 @@ KSysGuard::SensorInfoMap Daemon::sensors(const QStringList &sensorPaths) const
     return si;
 }
 
-void Daemon::subscribe(const QStringList &sensorIds)
+Client *Daemon::senderClient()
 {
     const QString sender = QDBusContext::message().service();
     m_serviceWatcher->addWatchedService(sender);
@@ -176,7 +447,12 @@ void Daemon::subscribe(const QStringList &sensorIds)
         client = new Client(this, sender);
         m_clients[sender] = client;
     }
-    client->subscribeSensors(sensorIds);
+    return client;
+}
+
+void Daemon::subscribe(const QStringList &sensorIds)
+{
+    senderClient()->subscribeSensors(sensorIds);
 }
 
 void Daemon::unsubscribe(const QStringList &sensorIds)
@@ -190,6 +466,55 @@ void Daemon::unsubscribe(const QStringList &sensorIds)
 }
 
 KSysGuard::SensorDataList Daemon::sensorData(const QStringList &sensorIds)
+{
+    // Providers skip sensors nobody is subscribed to, so their values may be outdated.
+    // Updating providers outside of frames would change the values subscribers get, like
+    // rates computed over the time since the previous update, so only those that can be
+    // sampled like for bursts are. Other sensors have the values of the current frame.
+    QList<KSysGuard::SensorProperty *> unsubscribed;
+    for (const QString &sensorId : sensorIds) {
+        auto sensor = findSensor(sensorId);
+        if (sensor && !sensor->isSubscribed() && qobject_cast<BurstSampleProvider *>(providerOf(sensor))) {
+            unsubscribed.append(sensor);
+        }
+    }
+    if (unsubscribed.isEmpty()) {
+        return currentSensorData(sensorIds);
+    }
+    return sampleSensors(sensorIds, unsubscribed);
+}
+
+KSysGuard::SensorDataList Daemon::sampleSensors(const QStringList &sensorIds, const QList<KSysGuard::SensorProperty *> &sensors)
+{
+    QList<KSysGuard::SensorPlugin *> providers;
+    for (auto sensor : sensors) {
+        sensor->subscribe();
+        auto provider = providerOf(sensor);
+        if (provider && !providers.contains(provider)) {
+            providers.append(provider);
+        }
+    }
+
+    for (auto provider : std::as_const(providers)) {
+        auto state = m_providerStates.find(provider);
+        // Providers the watchdog throttled keep the values of their last update, requests
+        // for their sensors should not update them more often than the frames do
+        if (state == m_providerStates.end() || state->throttledInterval.count() > 0) {
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        qobject_cast<BurstSampleProvider *>(provider)->sampleBurst();
+        updateWatchdog(provider, *state, std::chrono::steady_clock::now() - start);
+    }
+
+    const KSysGuard::SensorDataList sensorData = currentSensorData(sensorIds);
+    for (auto sensor : sensors) {
+        sensor->unsubscribe();
+    }
+    return sensorData;
+}
+
+KSysGuard::SensorDataList Daemon::currentSensorData(const QStringList &sensorIds) const
 {
     KSysGuard::SensorDataList sensorData;
     for (const QString &sensorId: sensorIds) {
@@ -203,6 +528,431 @@ KSysGuard::SensorDataList Daemon::sensorData(const QStringList &sensorIds)
     return sensorData;
 }
 
+QVariantMap Daemon::providers() const
+{
+    const KConfigGroup config = pluginsConfig();
+    QVariantMap providers;
+    for (const KPluginMetaData &metaData : m_plugins) {
+        const auto provider = providerForPlugin(metaData.pluginId());
+        QVariantMap entry{
+            {QStringLiteral("enabled"), metaData.isEnabled(config)},
+            {QStringLiteral("loaded"), provider != nullptr},
+            {QStringLiteral("updateInterval"), config.group(metaData.pluginId()).readEntry("UpdateInterval", 0u)},
+        };
+        if (provider) {
+            const auto state = m_providerStates.value(provider);
+            entry.insert(QStringLiteral("updateBudget"), uint(state.updateBudget.count()));
+            entry.insert(QStringLiteral("lastUpdateDuration"), std::chrono::duration<double, std::milli>(state.lastUpdateDuration).count());
+            entry.insert(QStringLiteral("overruns"), state.overruns);
+            entry.insert(QStringLiteral("throttledInterval"), uint(state.throttledInterval.count()));
+        }
+        providers.insert(metaData.pluginId(), entry);
+    }
+    return providers;
+}
+
+void Daemon::setProviderEnabled(const QString &pluginId, bool enabled)
+{
+    auto metaData = std::find_if(m_plugins.cbegin(), m_plugins.cend(), [&pluginId](const KPluginMetaData &metaData) {
+        return metaData.pluginId() == pluginId;
+    });
+    if (metaData == m_plugins.cend()) {
+        sendErrorReply(QDBusError::InvalidArgs, u"No plugin with id %1"_s.arg(pluginId));
+        return;
+    }
+
+    auto config = pluginsConfig();
+    config.writeEntry(pluginId + QLatin1String("Enabled"), enabled);
+    config.sync();
+
+    auto provider = providerForPlugin(pluginId);
+    if (enabled && !provider) {
+        if (!loadPlugin(*metaData)) {
+            sendErrorReply(QDBusError::Failed, u"Could not load plugin %1"_s.arg(pluginId));
+        }
+    } else if (!enabled && provider) {
+        unloadProvider(provider);
+    }
+}
+
+void Daemon::reloadProvider(const QString &pluginId)
+{
+    auto provider = providerForPlugin(pluginId);
+    auto metaData = std::find_if(m_plugins.cbegin(), m_plugins.cend(), [&pluginId](const KPluginMetaData &metaData) {
+        return metaData.pluginId() == pluginId;
+    });
+    if (!provider || metaData == m_plugins.cend()) {
+        sendErrorReply(QDBusError::InvalidArgs, u"No loaded plugin with id %1"_s.arg(pluginId));
+        return;
+    }
+
+    // An earlier reload that is still waiting for sensors ends now
+    finishReload();
+
+    // Clients are not told about sensors that are removed and added again, so they do not
+    // need to fetch the metadata and subscribe again
+    const auto containers = provider->containers();
+    for (auto container : containers) {
+        const auto objects = container->objects();
+        for (auto object : objects) {
+            const auto sensors = object->sensors();
+            for (auto sensor : sensors) {
+                m_reloadedSensors.insert(sensor->path(), {});
+            }
+        }
+    }
+    for (auto client : std::as_const(m_clients)) {
+        QStringList paths = client->subscribedSensors();
+        paths.removeIf([this](const QString &path) {
+            return !m_reloadedSensors.contains(path);
+        });
+        client->unsubscribeSensors(paths);
+        for (const QString &path : std::as_const(paths)) {
+            m_reloadedSensors[path].append(client);
+        }
+    }
+
+    // Keep the settings changed at runtime
+    const ProviderState state = m_providerStates.value(provider);
+    unloadProvider(provider);
+    if (!loadPlugin(*metaData)) {
+        finishReload();
+        sendErrorReply(QDBusError::Failed, u"Could not load plugin %1"_s.arg(pluginId));
+        return;
+    }
+
+    auto &newState = m_providerStates[providerForPlugin(pluginId)];
+    newState.updateInterval = state.updateInterval;
+    newState.updateBudget = state.updateBudget;
+
+    // Some providers only add their objects later, like devices found asynchronously
+    if (!m_reloadedSensors.isEmpty()) {
+        m_reloadTimer->start();
+    }
+}
+
+void Daemon::finishReload()
+{
+    m_reloadTimer->stop();
+    // What is left did not come back
+    const auto removed = std::exchange(m_reloadedSensors, {});
+    for (auto it = removed.cbegin(); it != removed.cend(); ++it) {
+        Q_EMIT sensorRemoved(it.key());
+    }
+}
+
+void Daemon::setProviderUpdateInterval(const QString &pluginId, uint interval)
+{
+    const bool exists = std::any_of(m_plugins.cbegin(), m_plugins.cend(), [&pluginId](const KPluginMetaData &metaData) {
+        return metaData.pluginId() == pluginId;
+    });
+    if (!exists) {
+        sendErrorReply(QDBusError::InvalidArgs, u"No plugin with id %1"_s.arg(pluginId));
+        return;
+    }
+
+    auto config = pluginsConfig().group(pluginId);
+    config.writeEntry("UpdateInterval", interval);
+    config.sync();
+
+    if (auto provider = providerForPlugin(pluginId)) {
+        auto &state = m_providerStates[provider];
+        state.updateInterval = std::chrono::milliseconds{interval};
+        state.nextUpdate = {};
+    }
+}
+
+uint Daemon::updateInterval() const
+{
+    return m_updateTimer->interval();
+}
+
+void Daemon::setUpdateInterval(uint interval)
+{
+    if (std::chrono::milliseconds{interval} < MinimumUpdateRate) {
+        sendErrorReply(QDBusError::InvalidArgs, u"The update interval needs to be at least %1 ms"_s.arg(MinimumUpdateRate.count()));
+        return;
+    }
+
+    auto config = m_config->group(u"General"_s);
+    config.writeEntry("UpdateInterval", interval);
+    config.sync();
+
+    m_updateTimer->setInterval(std::chrono::milliseconds{interval});
+    m_frameDeadline->setInterval(std::min(AsyncUpdateDeadline, m_updateTimer->intervalAsDuration() / 2));
+}
+
+KSysGuard::SensorDataList Daemon::snapshot(const QStringList &sensorIds, qulonglong &generation, qlonglong &timestamp)
+{
+    // Unlike sensorData(), all values need to come from the same frame. The client
+    // replies once that is the case, which may only be after the next frame.
+    setDelayedReply(true);
+    senderClient()->snapshot(sensorIds, message());
+
+    generation = 0;
+    timestamp = 0;
+    return {};
+}
+
+uint Daemon::startBurst(const QStringList &sensorIds, uint interval, uint duration)
+{
+    const auto burstInterval = std::chrono::milliseconds{interval};
+    const auto burstDuration = std::chrono::milliseconds{duration};
+    if (burstInterval < BurstSampler::MinimumInterval || burstDuration > BurstSampler::MaximumDuration) {
+        sendErrorReply(QDBusError::InvalidArgs,
+                       u"Bursts need an interval of at least %1 ms and may last at most %2 ms"_s.arg(BurstSampler::MinimumInterval.count())
+                           .arg(BurstSampler::MaximumDuration.count()));
+        return 0;
+    }
+    if (sensorIds.size() > BurstSampler::MaximumSensorsPerBurst) {
+        sendErrorReply(QDBusError::InvalidArgs, u"Bursts may contain at most %1 sensors"_s.arg(BurstSampler::MaximumSensorsPerBurst));
+        return 0;
+    }
+    const QString sender = message().service();
+    if (m_burstSampler->burstCount(sender) >= BurstSampler::MaximumBurstsPerOwner) {
+        sendErrorReply(QDBusError::LimitsExceeded, u"A client may run at most %1 bursts at once"_s.arg(BurstSampler::MaximumBurstsPerOwner));
+        return 0;
+    }
+
+    QList<KSysGuard::SensorProperty *> sensors;
+    for (const QString &sensorId : sensorIds) {
+        auto sensor = findSensor(sensorId);
+        if (!sensor) {
+            continue;
+        }
+        // Updating other providers that often would change the values subscribers get, like
+        // rates computed over the time since the previous update
+        auto provider = providerOf(sensor);
+        if (!qobject_cast<BurstSampleProvider *>(provider)) {
+            sendErrorReply(QDBusError::InvalidArgs, u"Sensor %1 cannot be sampled in bursts"_s.arg(sensorId));
+            return 0;
+        }
+        if (m_providerStates.value(provider).throttledInterval.count() > 0) {
+            sendErrorReply(QDBusError::Failed, u"Sensor %1 cannot be sampled in bursts while its updates take too long"_s.arg(sensorId));
+            return 0;
+        }
+        sensors.append(sensor);
+    }
+    if (sensors.isEmpty()) {
+        sendErrorReply(QDBusError::InvalidArgs, u"None of the sensors of the burst exist"_s);
+        return 0;
+    }
+
+    // Bursts of disconnected clients need to be removed
+    m_serviceWatcher->addWatchedService(sender);
+    return m_burstSampler->start(sender, sensors, burstInterval, burstDuration);
+}
+
+void Daemon::stopBurst(uint id)
+{
+    if (!m_burstSampler->stop(message().service(), id)) {
+        sendErrorReply(QDBusError::InvalidArgs, u"No burst with id %1"_s.arg(id));
+    }
+}
+
+void Daemon::setTracingEnabled(bool enabled)
+{
+    if (!m_frameTrace) {
+        if (enabled) {
+            createFrameTrace();
+        }
+        return;
+    }
+    m_frameTrace->setEnabled(enabled);
+}
+
+QString Daemon::trace()
+{
+    if (!m_frameTrace) {
+        sendErrorReply(QDBusError::Failed, u"Tracing was not enabled"_s);
+        return QString();
+    }
+    return QString::fromUtf8(m_frameTrace->toJson());
+}
+
+void Daemon::saveTrace(const QString &fileName)
+{
+    if (!m_frameTrace) {
+        sendErrorReply(QDBusError::Failed, u"Tracing was not enabled"_s);
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(m_frameTrace->toJson()) == -1) {
+        sendErrorReply(QDBusError::Failed, u"Could not write %1: %2"_s.arg(fileName, file.errorString()));
+    }
+}
+
+QVariantMap Daemon::clientStatistics() const
+{
+    QVariantMap statistics;
+    for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it) {
+        statistics.insert(it.key(), QVariantMap{
+            {QStringLiteral("droppedFrames"), it.value()->droppedFrames()},
+            {QStringLiteral("slow"), it.value()->isSlow()},
+        });
+    }
+    return statistics;
+}
+
+QVariantMap Daemon::querySensors(const QVariantMap &filter, const QStringList &fields)
+{
+    SensorIndex::Filter indexFilter;
+    for (auto it = filter.cbegin(); it != filter.cend(); ++it) {
+        if (it.key() == u"unit") {
+            bool ok = false;
+            const int unit = it->toInt(&ok);
+            if (!ok) {
+                sendErrorReply(QDBusError::InvalidArgs, u"The unit needs to be a number"_s);
+                return {};
+            }
+            indexFilter.unit = static_cast<KSysGuard::Unit>(unit);
+        } else if (it.key() == u"type") {
+            const QMetaType type = QMetaType::fromName(it->toString().toUtf8());
+            if (!type.isValid()) {
+                sendErrorReply(QDBusError::InvalidArgs, u"Unknown type \"%1\""_s.arg(it->toString()));
+                return {};
+            }
+            indexFilter.type = static_cast<QMetaType::Type>(type.id());
+        } else if (it.key() == u"container") {
+            indexFilter.container = it->toString();
+        } else if (it.key() == u"name") {
+            indexFilter.name = it->toString();
+        } else {
+            sendErrorReply(QDBusError::InvalidArgs, u"Unknown filter \"%1\""_s.arg(it.key()));
+            return {};
+        }
+    }
+
+    using Field = QVariant (*)(const KSysGuard::SensorInfo &);
+    static const QHash<QString, Field> availableFields = {
+        {u"name"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(info.name); }},
+        {u"shortName"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(info.shortName); }},
+        {u"description"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(info.description); }},
+        {u"prefix"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(info.prefix); }},
+        {u"unit"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(int(info.unit)); }},
+        {u"type"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(QString::fromLatin1(QMetaType(info.variantType).name())); }},
+        {u"min"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(info.min); }},
+        {u"max"_s, [](const KSysGuard::SensorInfo &info) { return QVariant(info.max); }},
+    };
+    QList<std::pair<QString, Field>> requestedFields;
+    for (const QString &field : fields) {
+        const auto it = availableFields.constFind(field);
+        if (it == availableFields.cend()) {
+            sendErrorReply(QDBusError::InvalidArgs, u"Unknown field \"%1\""_s.arg(field));
+            return {};
+        }
+        requestedFields.append({field, *it});
+    }
+
+    QVariantMap result;
+    const auto matches = m_sensorIndex.find(indexFilter);
+    for (auto sensor : matches) {
+        QVariantMap entry;
+        if (!requestedFields.isEmpty()) {
+            const KSysGuard::SensorInfo info = sensor->info();
+            for (const auto &[name, field] : std::as_const(requestedFields)) {
+                entry.insert(name, field(info));
+            }
+        }
+        result.insert(sensor->path(), entry);
+    }
+    return result;
+}
+
+uint Daemon::addThresholdRule(const QString &pattern, const QString &comparison, double value, double hysteresis, uint minimumDuration)
+{
+    const auto parsedComparison = ThresholdRule::parseComparison(comparison);
+    if (!parsedComparison) {
+        sendErrorReply(QDBusError::InvalidArgs, u"Unknown comparison \"%1\", expected one of >, >=, < or <="_s.arg(comparison));
+        return 0;
+    }
+    if (Client *client = m_clients.value(message().service()); client && client->thresholdRuleCount() >= Client::MaximumThresholdRules) {
+        sendErrorReply(QDBusError::LimitsExceeded, u"A client may have at most %1 threshold rules"_s.arg(Client::MaximumThresholdRules));
+        return 0;
+    }
+
+    auto rule = std::make_unique<ThresholdRule>(pattern, *parsedComparison, value, hysteresis, std::chrono::milliseconds(minimumDuration));
+    return senderClient()->addThresholdRule(std::move(rule));
+}
+
+void Daemon::removeThresholdRule(uint id)
+{
+    Client *client = m_clients.value(QDBusContext::message().service());
+    if (!client || !client->removeThresholdRule(id)) {
+        sendErrorReply(QDBusError::InvalidArgs, u"No threshold rule with id %1"_s.arg(id));
+    }
+}
+
+DerivedSensors *Daemon::derivedSensors()
+{
+    if (!m_derivedSensors) {
+        // Not part of m_providers as it needs to be updated after all other providers
+        m_derivedSensors = new DerivedSensors(this);
+        registerContainers(m_derivedSensors);
+        // Sources of a reloaded provider are replaced by new sensors with the same path
+        connect(this, &Daemon::sensorRegistered, m_derivedSensors, &DerivedSensors::replaceSource);
+    }
+    return m_derivedSensors;
+}
+
+void Daemon::addDerivedSensor(const QString &id, const QString &name, const QString &expression)
+{
+    QString errorMessage;
+    auto resolve = [this](const QString &path) {
+        return findSensor(path);
+    };
+    if (!derivedSensors()->addSensor(id, name, expression, resolve, &errorMessage)) {
+        sendErrorReply(QDBusError::InvalidArgs, errorMessage);
+    }
+}
+
+void Daemon::addPercentileSensor(const QString &id, const QString &name, const QString &sensorId, double percentile, uint window)
+{
+    auto source = findSensor(sensorId);
+    if (!source) {
+        sendErrorReply(QDBusError::InvalidArgs, u"Unknown sensor %1"_s.arg(sensorId));
+        return;
+    }
+
+    QString errorMessage;
+    if (!derivedSensors()->addPercentileSensor(id, name, source, percentile, std::chrono::seconds{window}, &errorMessage)) {
+        sendErrorReply(QDBusError::InvalidArgs, errorMessage);
+    }
+}
+
+void Daemon::addHistogramSensor(const QString &id, const QString &name, const QString &sensorId, const QList<double> &boundaries, uint window)
+{
+    auto source = findSensor(sensorId);
+    if (!source) {
+        sendErrorReply(QDBusError::InvalidArgs, u"Unknown sensor %1"_s.arg(sensorId));
+        return;
+    }
+
+    QString errorMessage;
+    if (!derivedSensors()->addHistogramSensor(id, name, source, boundaries, std::chrono::seconds{window}, &errorMessage)) {
+        sendErrorReply(QDBusError::InvalidArgs, errorMessage);
+    }
+}
+
+void Daemon::removeDerivedSensor(const QString &id)
+{
+    if (!m_derivedSensors || !m_derivedSensors->removeSensor(id)) {
+        sendErrorReply(QDBusError::InvalidArgs, u"No derived sensor with id %1"_s.arg(id));
+    }
+}
+
+KSysGuard::SensorPlugin *Daemon::providerOf(KSysGuard::SensorProperty *sensor)
+{
+    // Properties are children of their object, which is a child of a container owned by the plugin
+    for (QObject *object = sensor->parent(); object; object = object->parent()) {
+        if (auto provider = qobject_cast<KSysGuard::SensorPlugin *>(object)) {
+            return provider;
+        }
+    }
+    return nullptr;
+}
+
 KSysGuard::SensorProperty *Daemon::findSensor(const QString &path) const
 {
     int subsystemIndex = path.indexOf('/');
@@ -223,6 +973,23 @@ KSysGuard::SensorProperty *Daemon::findSensor(const QString &path) const
     return o->sensor(property);
 }
 
+QList<KSysGuard::SensorProperty *> Daemon::sensorProperties() const
+{
+    QList<KSysGuard::SensorProperty *> properties;
+    for (auto c : std::as_const(m_containers)) {
+        const auto objects = c->objects();
+        for (auto object : objects) {
+            properties.append(object->sensors());
+        }
+    }
+    return properties;
+}
+
+FrameBuilder *Daemon::frameBuilder() const
+{
+    return m_frameBuilder;
+}
+
 void Daemon::onServiceDisconnected(const QString &service)
 {
     if (service == KSysGuard::SystemStats::ServiceName) {
@@ -230,6 +997,7 @@ void Daemon::onServiceDisconnected(const QString &service)
     }
 
     delete m_clients.take(service);
+    m_burstSampler->removeOwner(service);
     if (m_clients.isEmpty() && m_quitOnLastClientDisconnect) {
         QCoreApplication::quit();
     };
@@ -237,7 +1005,7 @@ void Daemon::onServiceDisconnected(const QString &service)
 
 bool Daemon::registerDBusService(const QString& serviceName, ReplaceIfRunning replace)
 {
-    auto interface = QDBusConnection::sessionBus().interface();
+    auto interface = m_connection.interface();
 
     if (interface->isServiceRegistered(serviceName) && replace != ReplaceIfRunning::Replace) {
         qCWarning(KSYSTEMSTATS_DAEMON) << "ksystemstats is already running";
@@ -261,13 +1029,136 @@ bool Daemon::registerDBusService(const QString& serviceName, ReplaceIfRunning re
 
 void Daemon::sendFrame()
 {
+    FrameTrace::Span frameSpan(m_frameTrace.get(), u"sendFrame"_s);
+    if (m_frameDeadline->isActive()) {
+        // Should not happen as the deadline is shorter than the update interval
+        m_frameDeadline->stop();
+        finishFrame();
+    }
+
+    const auto now = std::chrono::steady_clock::now();
     for (auto provider : std::as_const(m_providers)) {
-        provider->update();
+        auto &state = m_providerStates[provider];
+        const auto interval = std::max(state.updateInterval, state.throttledInterval);
+        if (interval.count() > 0) {
+            // Providers with a custom interval are updated with the first frame after it elapsed
+            if (now < state.nextUpdate) {
+                continue;
+            }
+            state.nextUpdate = now + interval;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            FrameTrace::Span span(m_frameTrace.get(), state.traceName);
+            provider->update();
+        }
+        // Only the asynchronous part of an asynchronous provider counts against its budget
+        if (auto asyncProvider = qobject_cast<AsyncUpdateProvider *>(provider)) {
+            startAsyncUpdate(provider, asyncProvider, state);
+        } else {
+            updateWatchdog(provider, state, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    if (m_awaitedUpdates.isEmpty()) {
+        finishFrame();
+    } else {
+        m_frameDeadline->start();
+    }
+}
+
+void Daemon::startAsyncUpdate(KSysGuard::SensorPlugin *provider, AsyncUpdateProvider *asyncProvider, ProviderState &state)
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (state.asyncUpdatePending) {
+        // Still busy with an earlier frame, its values are sent once they arrive
+        if (now - state.asyncUpdateStart < AsyncUpdateTimeout) {
+            return;
+        }
+        // Waiting for an update that hangs would keep the provider from ever being updated again
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Provider" << provider->providerName() << "did not finish its update within" << AsyncUpdateTimeout;
+        state.asyncUpdatePending = false;
+        updateWatchdog(provider, state, now - state.asyncUpdateStart);
+    }
+
+    state.asyncUpdateStart = now;
+    // Unique across providers, a reloaded provider may get the address of the previous one
+    const quint64 update = ++m_lastAsyncUpdate;
+    state.asyncUpdate = update;
+    const QFuture<void> future = asyncProvider->updateAsync();
+    if (future.isFinished()) {
+        traceAsyncUpdate(state);
+        updateWatchdog(provider, state, std::chrono::steady_clock::now() - state.asyncUpdateStart);
+        return;
+    }
+    state.asyncUpdatePending = true;
+    m_awaitedUpdates.insert(provider);
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, provider, update]() {
+        watcher->deleteLater();
+        onAsyncUpdateFinished(provider, update);
+    });
+    watcher->setFuture(future);
+}
+
+void Daemon::onAsyncUpdateFinished(KSysGuard::SensorPlugin *provider, quint64 update)
+{
+    // The provider may have been unloaded in the meantime, so only use it as a key
+    auto state = m_providerStates.find(provider);
+    // Updates that timed out were already accounted for
+    if (state == m_providerStates.end() || !state->asyncUpdatePending || state->asyncUpdate != update) {
+        return;
+    }
+    state->asyncUpdatePending = false;
+    traceAsyncUpdate(*state);
+    updateWatchdog(provider, *state, std::chrono::steady_clock::now() - state->asyncUpdateStart);
+
+    if (m_awaitedUpdates.remove(provider) && m_awaitedUpdates.isEmpty() && m_frameDeadline->isActive()) {
+        m_frameDeadline->stop();
+        finishFrame();
+    }
+}
+
+void Daemon::traceAsyncUpdate(const ProviderState &state)
+{
+    // Recorded once finished, as it spans several iterations of the event loop
+    if (m_frameTrace && m_frameTrace->isEnabled()) {
+        m_frameTrace->record(m_frameTrace->intern(state.traceName), state.asyncUpdateStart, std::chrono::steady_clock::now());
+    }
+}
+
+void Daemon::finishFrame()
+{
+    FrameTrace::Span frameSpan(m_frameTrace.get(), u"finishFrame"_s);
+
+    if (!m_awaitedUpdates.isEmpty()) {
+        qCDebug(KSYSTEMSTATS_DAEMON) << m_awaitedUpdates.size() << "providers missed the frame deadline";
+        m_awaitedUpdates.clear();
+    }
+
+    if (m_derivedSensors) {
+        FrameTrace::Span span(m_frameTrace.get(), u"derived sensors"_s);
+        m_derivedSensors->update();
+    }
+    {
+        FrameTrace::Span span(m_frameTrace.get(), u"buildFrame"_s);
+        m_frameBuilder->buildFrame();
+    }
+    if (m_valueTable) {
+        FrameTrace::Span span(m_frameTrace.get(), u"value table"_s);
+        m_valueTable->write();
     }
 
     for (auto client: std::as_const(m_clients)) {
         client->sendFrame();
     }
+    if (m_socketServer) {
+        FrameTrace::Span span(m_frameTrace.get(), u"socket clients"_s);
+        m_socketServer->sendFrame();
+    }
+    FrameTrace::Span burstSpan(m_frameTrace.get(), u"bursts"_s);
+    m_burstSampler->deliver();
 }
 
 #include "moc_daemon.cpp"
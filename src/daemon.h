@@ -6,20 +6,42 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
+
+#include <QDBusConnection>
 #include <QDBusContext>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+
+#include <KConfigGroup>
+#include <KPluginMetaData>
+#include <KSharedConfig>
 
 #include <systemstats/SensorInfo.h>
 
+#include "burstsampler.h"
+#include "metadatastore.h"
+#include "sensorindex.h"
+
 namespace KSysGuard
 {
     class SensorPlugin;
     class SensorContainer;
+    class SensorObject;
     class SensorProperty;
 }
 
+class AsyncUpdateProvider;
 class Client;
+class DerivedSensors;
+class FrameBuilder;
+class FrameTrace;
 class QDBusServiceWatcher;
+class QTimer;
+class SocketServer;
+class ValueTable;
 
 /**
  * The main central application
@@ -28,15 +50,29 @@ class Daemon : public QObject, public QDBusContext
 {
     Q_OBJECT
 public:
+    static inline const QString ControlInterface = QStringLiteral("org.kde.ksystemstats1.Control");
+
     enum class ReplaceIfRunning {
         Replace,
         DoNotReplace
     };
 
-    Daemon();
+    /**
+     * @param connection The bus to serve clients on. On the system bus a single
+     * instance serves the clients of all users, see SystemProxy.
+     */
+    explicit Daemon(const QDBusConnection &connection = QDBusConnection::sessionBus());
     ~Daemon();
     bool init(ReplaceIfRunning replaceIfRunning);
+    QDBusConnection connection() const;
     KSysGuard::SensorProperty *findSensor(const QString &path) const;
+    static KSysGuard::SensorPlugin *providerOf(KSysGuard::SensorProperty *sensor);
+    QList<KSysGuard::SensorProperty *> sensorProperties() const;
+    FrameBuilder *frameBuilder() const;
+    /**
+     * Null unless tracing was enabled at some point.
+     */
+    FrameTrace *frameTrace() const;
 
     void setQuitOnLastClientDisconnect(bool quit);
 
@@ -50,27 +86,135 @@ public Q_SLOTS:
 
     KSysGuard::SensorDataList sensorData(const QStringList &sensorIds);
 
+    // DBus, org.kde.ksystemstats1.Control
+    QVariantMap clientStatistics() const;
+    QVariantMap querySensors(const QVariantMap &filter, const QStringList &fields);
+    uint addThresholdRule(const QString &pattern, const QString &comparison, double value, double hysteresis, uint minimumDuration);
+    void removeThresholdRule(uint id);
+    void addDerivedSensor(const QString &id, const QString &name, const QString &expression);
+    void addPercentileSensor(const QString &id, const QString &name, const QString &sensorId, double percentile, uint window);
+    void addHistogramSensor(const QString &id, const QString &name, const QString &sensorId, const QList<double> &boundaries, uint window);
+    void removeDerivedSensor(const QString &id);
+    QVariantMap providers() const;
+    void setProviderEnabled(const QString &pluginId, bool enabled);
+    void reloadProvider(const QString &pluginId);
+    void setProviderUpdateInterval(const QString &pluginId, uint interval);
+    uint updateInterval() const;
+    void setUpdateInterval(uint interval);
+    KSysGuard::SensorDataList snapshot(const QStringList &sensorIds, qulonglong &generation, qlonglong &timestamp);
+    uint startBurst(const QStringList &sensorIds, uint interval, uint duration);
+    void stopBurst(uint id);
+    void setTracingEnabled(bool enabled);
+    QString trace();
+    void saveTrace(const QString &fileName);
+
 Q_SIGNALS:
     // DBus
     void sensorAdded(const QString &sensorId);
     void sensorRemoved(const QString &sensorId);
+    // Internal, unlike the above also for sensors of a reloaded provider that keep their path
+    void sensorRegistered(KSysGuard::SensorProperty *sensor);
+    void sensorUnregistered(const QString &sensorId);
     // not emitted directly as we use targetted signals via lower level API
     void newSensorData(const KSysGuard::SensorDataList &sensorData);
+    // DBus, org.kde.ksystemstats1.Control, also sent as targetted signal
+    void thresholdStateChanged(uint rule, const QString &sensorId, bool active, double value);
+    void burstSamples(uint burst, const BurstSamplesList &samples, bool finished);
 
 protected:
     // virtual for autotest to override and not load real plugins
     virtual void loadProviders();
+    // virtual for autotest to provide plugins that are not installed
+    virtual KSysGuard::SensorPlugin *instantiatePlugin(const KPluginMetaData &metaData);
 
     void sendFrame();
     void registerProvider(KSysGuard::SensorPlugin *);
+    // Loads the plugin unless it is disabled
+    void addPlugin(const KPluginMetaData &metaData);
 
 private:
+    // How long a provider may take to update, unless configured otherwise
+    static constexpr std::chrono::milliseconds DefaultUpdateBudget{50};
+
+    struct ProviderState {
+        // Empty for providers that were not loaded from a plugin
+        QString pluginId;
+        // Zero to update with every frame
+        std::chrono::milliseconds updateInterval{0};
+        std::chrono::steady_clock::time_point nextUpdate;
+
+        // Watchdog, see updateWatchdog()
+        std::chrono::milliseconds updateBudget = DefaultUpdateBudget;
+        std::chrono::microseconds lastUpdateDuration{0};
+        // Set by the watchdog for providers that do not keep within their budget
+        std::chrono::milliseconds throttledInterval{0};
+        quint64 overruns = 0;
+        int consecutiveOverruns = 0;
+        int consecutiveUpdatesInBudget = 0;
+
+        // For providers implementing AsyncUpdateProvider
+        bool asyncUpdatePending = false;
+        std::chrono::steady_clock::time_point asyncUpdateStart;
+        // Id of the current update, to tell a late one that timed out from the current one
+        quint64 asyncUpdate = 0;
+
+        // Name of the update() trace point, see FrameTrace
+        QString traceName;
+    };
+
+    bool loadPlugin(const KPluginMetaData &metaData);
+    void unloadProvider(KSysGuard::SensorPlugin *provider);
+    KSysGuard::SensorPlugin *providerForPlugin(const QString &pluginId) const;
+    KConfigGroup pluginsConfig() const;
+    void updateWatchdog(KSysGuard::SensorPlugin *provider, ProviderState &state, std::chrono::steady_clock::duration duration);
+    void startAsyncUpdate(KSysGuard::SensorPlugin *provider, AsyncUpdateProvider *asyncProvider, ProviderState &state);
+    void onAsyncUpdateFinished(KSysGuard::SensorPlugin *provider, quint64 update);
+    void traceAsyncUpdate(const ProviderState &state);
+    void finishFrame();
+    KSysGuard::SensorDataList currentSensorData(const QStringList &sensorIds) const;
+    // Updates the providers of @p sensors through BurstSampleProvider and returns the values of @p sensorIds
+    KSysGuard::SensorDataList sampleSensors(const QStringList &sensorIds, const QList<KSysGuard::SensorProperty *> &sensors);
+    void registerContainers(KSysGuard::SensorPlugin *provider);
+    void notifySensorsAdded(KSysGuard::SensorObject *object);
+    void notifySensorsRemoved(KSysGuard::SensorObject *object);
+    void scheduleMetaDataPrune();
+    void finishReload();
+    void createValueTable();
+    void createSocketServer();
+    void createFrameTrace();
+    Client *senderClient();
+    DerivedSensors *derivedSensors();
     void onServiceDisconnected(const QString &service);
     bool registerDBusService(const QString &serviceName, ReplaceIfRunning replace);
 
     QList<KSysGuard::SensorPlugin *> m_providers;
+    QHash<KSysGuard::SensorPlugin *, ProviderState> m_providerStates;
+    // All plugins that were found, including disabled ones
+    QList<KPluginMetaData> m_plugins;
+    QDBusConnection m_connection;
+    KSharedConfig::Ptr m_config;
+    QTimer *m_updateTimer;
+    // Running while the current frame waits for asynchronous updates
+    QTimer *m_frameDeadline;
+    // Running while a reloaded provider may still add sensors it had before
+    QTimer *m_reloadTimer;
+    // Asynchronous updates started for the current frame that did not finish yet
+    QSet<KSysGuard::SensorPlugin *> m_awaitedUpdates;
+    quint64 m_lastAsyncUpdate = 0;
+    DerivedSensors *m_derivedSensors = nullptr;
+    FrameBuilder *m_frameBuilder;
+    BurstSampler *m_burstSampler;
+    ValueTable *m_valueTable = nullptr;
+    SocketServer *m_socketServer = nullptr;
+    std::unique_ptr<FrameTrace> m_frameTrace;
     QHash<QString /*subscriber DBus base name*/, Client*> m_clients;
     QHash<QString /*id*/, KSysGuard::SensorContainer *> m_containers;
+    MetaDataStore m_metaDataStore;
+    bool m_metaDataPrunePending = false;
+    SensorIndex m_sensorIndex;
+    // Sensors of a reloaded provider that did not appear again yet, with the clients
+    // subscribed to them, see reloadProvider()
+    QHash<QString, QList<QPointer<Client>>> m_reloadedSensors;
     QDBusServiceWatcher *m_serviceWatcher;
     bool m_quitOnLastClientDisconnect = true;
 };
@@ -0,0 +1,283 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "derivedsensors.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include <systemstats/SensorContainer.h>
+#include <systemstats/SensorObject.h>
+#include <systemstats/SensorProperty.h>
+
+using namespace Qt::StringLiterals;
+
+DerivedSensors::DerivedSensors(QObject *parent)
+    : SensorPlugin(parent, {})
+    , m_container(new KSysGuard::SensorContainer(u"derived"_s, u"Derived Sensors"_s, this))
+{
+}
+
+DerivedSensors::~DerivedSensors() = default;
+
+QString DerivedSensors::providerName() const
+{
+    return u"derived"_s;
+}
+
+void DerivedSensors::update()
+{
+    const auto now = QuantileSketch::Clock::now();
+    for (auto &[id, sensor] : m_sensors) {
+        if (sensor.subscribedProperties == 0) {
+            continue;
+        }
+        if (sensor.sketch) {
+            updateDistribution(sensor, now);
+            continue;
+        }
+        const double value = sensor.expression->evaluate();
+        if (!std::isnan(value)) {
+            sensor.properties.first()->setValue(value);
+        }
+    }
+}
+
+void DerivedSensors::updateDistribution(DerivedSensor &sensor, QuantileSketch::Clock::time_point now)
+{
+    bool ok = false;
+    const auto &source = sensor.sources.first();
+    const double value = source ? source->value().toDouble(&ok) : 0.0;
+    if (ok) {
+        sensor.sketch->add(value, now);
+    } else {
+        sensor.sketch->advance(now);
+    }
+    if (sensor.sketch->count() == 0) {
+        return;
+    }
+
+    if (sensor.boundaries.isEmpty()) {
+        sensor.properties.first()->setValue(sensor.sketch->quantile(sensor.quantile));
+        return;
+    }
+
+    double below = 0.0;
+    for (qsizetype i = 0; i < sensor.properties.size(); ++i) {
+        const double upTo = i < sensor.boundaries.size() ? sensor.sketch->rank(sensor.boundaries.at(i)) : 1.0;
+        sensor.properties.at(i)->setValue((upTo - below) * 100.0);
+        below = upTo;
+    }
+}
+
+bool DerivedSensors::isValidId(const QString &id, QString *errorMessage) const
+{
+    if (id.isEmpty() || id.contains(u'/')) {
+        *errorMessage = u"Invalid id \"%1\""_s.arg(id);
+        return false;
+    }
+    if (m_sensors.contains(id)) {
+        *errorMessage = u"A sensor with id \"%1\" already exists"_s.arg(id);
+        return false;
+    }
+    return true;
+}
+
+bool DerivedSensors::addSensor(const QString &id, const QString &name, const QString &expression, const Expression::SensorResolver &resolve, QString *errorMessage)
+{
+    if (!isValidId(id, errorMessage)) {
+        return false;
+    }
+    if (expression.size() > MaximumExpressionLength) {
+        *errorMessage = u"The expression must not be longer than %1 characters"_s.arg(MaximumExpressionLength);
+        return false;
+    }
+
+    auto compiled = Expression::compile(expression, resolve, errorMessage);
+    if (!compiled) {
+        return false;
+    }
+
+    const QString displayName = name.isEmpty() ? id : name;
+    auto object = new KSysGuard::SensorObject(id, displayName, m_container);
+    auto property = new KSysGuard::SensorProperty(u"value"_s, displayName, object);
+    property->setDescription(expression);
+    property->setVariantType(QVariant::Double);
+
+    const auto sources = compiled->sources();
+    // Keep the unit if all sources agree on one, for sums and averages of the same quantity
+    if (!sources.isEmpty()) {
+        const auto unit = sources.first()->info().unit;
+        if (std::all_of(sources.cbegin(), sources.cend(), [unit](KSysGuard::SensorProperty *source) {
+                return source->info().unit == unit;
+            })) {
+            property->setUnit(unit);
+        }
+    }
+
+    DerivedSensor sensor{object, {property}, {sources.cbegin(), sources.cend()}};
+    sensor.expression = std::move(compiled);
+    publish(id, std::move(sensor));
+    return true;
+}
+
+bool DerivedSensors::addPercentileSensor(const QString &id,
+                                         const QString &name,
+                                         KSysGuard::SensorProperty *source,
+                                         double percentile,
+                                         std::chrono::seconds window,
+                                         QString *errorMessage)
+{
+    if (!isValidId(id, errorMessage)) {
+        return false;
+    }
+    if (!(percentile >= 0.0 && percentile <= 100.0)) {
+        *errorMessage = u"The percentile needs to be between 0 and 100"_s;
+        return false;
+    }
+    if (window.count() <= 0 || window > MaximumWindow) {
+        *errorMessage = u"The window needs to be between 1 and %1 seconds"_s.arg(MaximumWindow.count());
+        return false;
+    }
+
+    const QString displayName = name.isEmpty() ? id : name;
+    auto object = new KSysGuard::SensorObject(id, displayName, m_container);
+    auto property = new KSysGuard::SensorProperty(u"value"_s, displayName, object);
+    property->setDescription(u"p%1 of %2 over %3 s"_s.arg(percentile).arg(source->path()).arg(window.count()));
+    property->setVariantType(QVariant::Double);
+    property->setUnit(source->info().unit);
+    property->setMin(source->info().min);
+    property->setMax(source->info().max);
+
+    DerivedSensor sensor{object, {property}, {source}};
+    sensor.sketch = std::make_unique<QuantileSketch>(window);
+    sensor.quantile = percentile / 100.0;
+    publish(id, std::move(sensor));
+    return true;
+}
+
+bool DerivedSensors::addHistogramSensor(const QString &id,
+                                        const QString &name,
+                                        KSysGuard::SensorProperty *source,
+                                        const QList<double> &boundaries,
+                                        std::chrono::seconds window,
+                                        QString *errorMessage)
+{
+    if (!isValidId(id, errorMessage)) {
+        return false;
+    }
+    if (boundaries.isEmpty() || std::adjacent_find(boundaries.cbegin(), boundaries.cend(), std::greater_equal<>()) != boundaries.cend()) {
+        *errorMessage = u"The bucket boundaries need to be in strictly ascending order"_s;
+        return false;
+    }
+    if (window.count() <= 0 || window > MaximumWindow) {
+        *errorMessage = u"The window needs to be between 1 and %1 seconds"_s.arg(MaximumWindow.count());
+        return false;
+    }
+
+    const QString displayName = name.isEmpty() ? id : name;
+    auto object = new KSysGuard::SensorObject(id, displayName, m_container);
+    DerivedSensor sensor{object, {}, {source}};
+    for (qsizetype i = 0; i <= boundaries.size(); ++i) {
+        QString bucketName;
+        if (i == 0) {
+            bucketName = u"≤ %1"_s.arg(boundaries.first());
+        } else if (i == boundaries.size()) {
+            bucketName = u"> %1"_s.arg(boundaries.last());
+        } else {
+            bucketName = u"%1 – %2"_s.arg(boundaries.at(i - 1)).arg(boundaries.at(i));
+        }
+        auto property = new KSysGuard::SensorProperty(u"bucket%1"_s.arg(i), bucketName, object);
+        property->setPrefix(displayName);
+        property->setDescription(u"Share of values of %1 over %2 s"_s.arg(source->path()).arg(window.count()));
+        property->setVariantType(QVariant::Double);
+        property->setUnit(KSysGuard::UnitPercent);
+        property->setMax(100);
+        sensor.properties.append(property);
+    }
+    sensor.sketch = std::make_unique<QuantileSketch>(window);
+    sensor.boundaries = boundaries;
+    publish(id, std::move(sensor));
+    return true;
+}
+
+void DerivedSensors::publish(const QString &id, DerivedSensor &&sensor)
+{
+    for (auto property : std::as_const(sensor.properties)) {
+        // Sources only need to be subscribed while any of the properties is
+        connect(property, &KSysGuard::SensorProperty::subscribedChanged, this, [this, id](bool subscribed) {
+            auto it = m_sensors.find(id);
+            if (it == m_sensors.end()) {
+                return;
+            }
+            auto &sensor = it->second;
+            const bool wasSubscribed = sensor.subscribedProperties > 0;
+            sensor.subscribedProperties += subscribed ? 1 : -1;
+            if (wasSubscribed != (sensor.subscribedProperties > 0)) {
+                setSourcesSubscribed(sensor, !wasSubscribed);
+            }
+        });
+    }
+    for (const auto &source : std::as_const(sensor.sources)) {
+        sensor.sourcePaths.append(source->path());
+    }
+    m_sensors.emplace(id, std::move(sensor));
+}
+
+void DerivedSensors::setSourcesSubscribed(const DerivedSensor &sensor, bool subscribed)
+{
+    for (const auto &source : sensor.sources) {
+        if (!source) {
+            continue;
+        }
+        if (subscribed) {
+            source->subscribe();
+        } else {
+            source->unsubscribe();
+        }
+    }
+}
+
+bool DerivedSensors::removeSensor(const QString &id)
+{
+    auto it = m_sensors.find(id);
+    if (it == m_sensors.end()) {
+        return false;
+    }
+
+    auto &sensor = it->second;
+    if (sensor.subscribedProperties > 0) {
+        setSourcesSubscribed(sensor, false);
+    }
+    m_container->removeObject(sensor.object);
+    sensor.object->deleteLater();
+    m_sensors.erase(it);
+    return true;
+}
+
+void DerivedSensors::replaceSource(KSysGuard::SensorProperty *sensor)
+{
+    const QString path = sensor->path();
+    for (auto &[id, derived] : m_sensors) {
+        const auto index = derived.sourcePaths.indexOf(path);
+        if (index < 0 || derived.sources.at(index) == sensor) {
+            continue;
+        }
+        if (derived.subscribedProperties > 0) {
+            if (const auto &previous = derived.sources.at(index)) {
+                previous->unsubscribe();
+            }
+            sensor->subscribe();
+        }
+        derived.sources[index] = sensor;
+        if (derived.expression) {
+            derived.expression->replaceSource(sensor);
+        }
+    }
+}
+
+#include "moc_derivedsensors.cpp"
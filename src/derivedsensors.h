@@ -0,0 +1,105 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include <systemstats/SensorPlugin.h>
+
+#include "expression.h"
+#include "quantilesketch.h"
+
+namespace KSysGuard
+{
+    class SensorContainer;
+    class SensorObject;
+    class SensorProperty;
+}
+
+/**
+ * Provides sensors whose values are computed from other sensors using an Expression,
+ * or from the distribution of the values of another sensor over a time window.
+ *
+ * Each sensor is published as "derived/<id>/value" and behaves like any other sensor,
+ * histograms are published as "derived/<id>/bucket<n>".
+ * update() needs to be called after all other providers have been updated.
+ */
+class DerivedSensors : public KSysGuard::SensorPlugin
+{
+    Q_OBJECT
+public:
+    explicit DerivedSensors(QObject *parent);
+    ~DerivedSensors() override;
+
+    QString providerName() const override;
+    void update() override;
+
+    /**
+     * Adds a sensor that computes @p expression.
+     * Returns false and fills @p errorMessage if @p id is invalid or already in use,
+     * or if the expression can not be compiled.
+     */
+    bool addSensor(const QString &id, const QString &name, const QString &expression, const Expression::SensorResolver &resolve, QString *errorMessage);
+    /**
+     * Adds a sensor that estimates the @p percentile, between 0 and 100, of the values
+     * of @p source over the last @p window.
+     */
+    bool addPercentileSensor(const QString &id,
+                             const QString &name,
+                             KSysGuard::SensorProperty *source,
+                             double percentile,
+                             std::chrono::seconds window,
+                             QString *errorMessage);
+    /**
+     * Adds a sensor per bucket delimited by @p boundaries, containing the percentage of
+     * values of @p source over the last @p window that fell into that bucket. The first
+     * bucket contains everything up to the first boundary, the last everything above the
+     * last boundary.
+     */
+    bool addHistogramSensor(const QString &id,
+                            const QString &name,
+                            KSysGuard::SensorProperty *source,
+                            const QList<double> &boundaries,
+                            std::chrono::seconds window,
+                            QString *errorMessage);
+    bool removeSensor(const QString &id);
+
+    /**
+     * Makes derived sensors use @p sensor as source instead of an earlier sensor with the
+     * same path, like after the provider of the sources was reloaded.
+     */
+    void replaceSource(KSysGuard::SensorProperty *sensor);
+
+    static constexpr std::chrono::seconds MaximumWindow{3600};
+    static constexpr qsizetype MaximumExpressionLength = 4096;
+
+private:
+    struct DerivedSensor {
+        KSysGuard::SensorObject *object;
+        QList<KSysGuard::SensorProperty *> properties;
+        QList<QPointer<KSysGuard::SensorProperty>> sources;
+        // Parallel to sources, to find them again once they were replaced
+        QStringList sourcePaths;
+        std::optional<Expression> expression;
+        // Set for percentile and histogram sensors
+        std::unique_ptr<QuantileSketch> sketch;
+        double quantile = 0.0;
+        QList<double> boundaries;
+        int subscribedProperties = 0;
+    };
+
+    bool isValidId(const QString &id, QString *errorMessage) const;
+    void publish(const QString &id, DerivedSensor &&sensor);
+    void setSourcesSubscribed(const DerivedSensor &sensor, bool subscribed);
+    void updateDistribution(DerivedSensor &sensor, QuantileSketch::Clock::time_point now);
+
+    KSysGuard::SensorContainer *m_container;
+    std::map<QString, DerivedSensor> m_sensors;
+};
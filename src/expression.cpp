@@ -0,0 +1,404 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "expression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include <systemstats/SensorProperty.h>
+
+using namespace Qt::StringLiterals;
+
+// The parser recurses for every parenthesis, function call and unary minus, deeper
+// nesting is rejected before it could overflow the stack
+constexpr int MaximumNesting = 64;
+
+class Expression::Parser
+{
+public:
+    Parser(const QString &source, const SensorResolver &resolve, Expression &expression)
+        : m_source(source)
+        , m_resolve(resolve)
+        , m_expression(expression)
+    {
+    }
+
+    bool parse()
+    {
+        if (!parseSum()) {
+            return false;
+        }
+        skipWhitespace();
+        if (m_position < m_source.size()) {
+            return fail(u"Unexpected '%1'"_s.arg(m_source.at(m_position)));
+        }
+        return true;
+    }
+
+    QString errorMessage;
+    int maximumDepth = 0;
+
+private:
+    // sum := product (('+' | '-') product)*
+    bool parseSum()
+    {
+        if (!parseProduct()) {
+            return false;
+        }
+        while (true) {
+            if (accept(u'+')) {
+                if (!parseProduct()) {
+                    return false;
+                }
+                append(Operation::Add, 2);
+            } else if (accept(u'-')) {
+                if (!parseProduct()) {
+                    return false;
+                }
+                append(Operation::Subtract, 2);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    // product := unary (('*' | '/') unary)*
+    bool parseProduct()
+    {
+        if (!parseUnary()) {
+            return false;
+        }
+        while (true) {
+            if (accept(u'*')) {
+                if (!parseUnary()) {
+                    return false;
+                }
+                append(Operation::Multiply, 2);
+            } else if (accept(u'/')) {
+                if (!parseUnary()) {
+                    return false;
+                }
+                append(Operation::Divide, 2);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    // unary := '-' unary | primary
+    bool parseUnary()
+    {
+        if (accept(u'-')) {
+            Nesting nesting(*this);
+            if (!nesting.isValid() || !parseUnary()) {
+                return false;
+            }
+            append(Operation::Negate, 1);
+            return true;
+        }
+        return parsePrimary();
+    }
+
+    // primary := number | path | '"' path '"' | function '(' sum (',' sum)* ')' | '(' sum ')'
+    bool parsePrimary()
+    {
+        skipWhitespace();
+        if (m_position >= m_source.size()) {
+            return fail(u"Unexpected end of expression"_s);
+        }
+
+        const QChar c = m_source.at(m_position);
+        if (accept(u'(')) {
+            Nesting nesting(*this);
+            if (!nesting.isValid() || !parseSum()) {
+                return false;
+            }
+            return expect(u')');
+        }
+
+        if (c.isDigit() || c == u'.') {
+            const qsizetype start = m_position;
+            while (m_position < m_source.size() && (m_source.at(m_position).isDigit() || m_source.at(m_position) == u'.')) {
+                ++m_position;
+            }
+            bool ok = false;
+            const double value = QStringView(m_source).mid(start, m_position - start).toDouble(&ok);
+            if (!ok) {
+                return fail(u"Invalid number at position %1"_s.arg(start));
+            }
+            m_expression.m_program.push_back(Instruction{Operation::Constant, 0, value});
+            push(1);
+            return true;
+        }
+
+        if (c == u'"') {
+            const qsizetype end = m_source.indexOf(u'"', m_position + 1);
+            if (end < 0) {
+                return fail(u"Unterminated sensor path at position %1"_s.arg(m_position));
+            }
+            const QString path = m_source.mid(m_position + 1, end - m_position - 1);
+            m_position = end + 1;
+            return appendSensor(path);
+        }
+
+        if (c.isLetter() || c == u'_') {
+            const qsizetype start = m_position;
+            while (m_position < m_source.size() && isPathCharacter(m_source.at(m_position))) {
+                ++m_position;
+            }
+            const QString name = m_source.mid(start, m_position - start);
+
+            skipWhitespace();
+            if (m_position < m_source.size() && m_source.at(m_position) == u'(') {
+                Nesting nesting(*this);
+                return nesting.isValid() && parseFunction(name);
+            }
+            return appendSensor(name);
+        }
+
+        return fail(u"Unexpected '%1'"_s.arg(c));
+    }
+
+    bool parseFunction(const QString &name)
+    {
+        Operation operation;
+        if (name == u"min") {
+            operation = Operation::Minimum;
+        } else if (name == u"max") {
+            operation = Operation::Maximum;
+        } else if (name == u"sum") {
+            operation = Operation::Sum;
+        } else if (name == u"avg") {
+            operation = Operation::Average;
+        } else {
+            return fail(u"Unknown function %1"_s.arg(name));
+        }
+
+        expect(u'(');
+        int arguments = 0;
+        do {
+            if (!parseSum()) {
+                return false;
+            }
+            ++arguments;
+        } while (accept(u','));
+        if (!expect(u')')) {
+            return false;
+        }
+        append(operation, arguments);
+        return true;
+    }
+
+    bool appendSensor(const QString &path)
+    {
+        KSysGuard::SensorProperty *sensor = m_resolve(path);
+        if (!sensor) {
+            return fail(u"Unknown sensor %1"_s.arg(path));
+        }
+
+        auto index = m_expression.m_sources.indexOf(sensor);
+        if (index < 0) {
+            index = m_expression.m_sources.size();
+            m_expression.m_sources.append(sensor);
+            m_expression.m_sourcePaths.append(sensor->path());
+        }
+        m_expression.m_program.push_back(Instruction{Operation::Sensor, int(index)});
+        push(1);
+        return true;
+    }
+
+    // Operations pop their arguments and push a single result
+    void append(Operation operation, int arguments)
+    {
+        m_expression.m_program.push_back(Instruction{operation, arguments});
+        m_depth -= arguments - 1;
+    }
+
+    void push(int count)
+    {
+        m_depth += count;
+        maximumDepth = std::max(maximumDepth, m_depth);
+    }
+
+    static bool isPathCharacter(QChar c)
+    {
+        return c.isLetterOrNumber() || c == u'_' || c == u'/' || c == u'.';
+    }
+
+    void skipWhitespace()
+    {
+        while (m_position < m_source.size() && m_source.at(m_position).isSpace()) {
+            ++m_position;
+        }
+    }
+
+    bool accept(char16_t c)
+    {
+        skipWhitespace();
+        if (m_position < m_source.size() && m_source.at(m_position) == c) {
+            ++m_position;
+            return true;
+        }
+        return false;
+    }
+
+    bool expect(char16_t c)
+    {
+        if (accept(c)) {
+            return true;
+        }
+        return fail(u"Expected '%1' at position %2"_s.arg(QChar(c)).arg(m_position));
+    }
+
+    bool fail(const QString &message)
+    {
+        if (errorMessage.isEmpty()) {
+            errorMessage = message;
+        }
+        return false;
+    }
+
+    // Counts the recursion of the parser for as long as it exists
+    class Nesting
+    {
+    public:
+        explicit Nesting(Parser &parser)
+            : m_parser(parser)
+        {
+            ++m_parser.m_nesting;
+        }
+        ~Nesting()
+        {
+            --m_parser.m_nesting;
+        }
+
+        Nesting(const Nesting &) = delete;
+        Nesting &operator=(const Nesting &) = delete;
+
+        bool isValid() const
+        {
+            return m_parser.m_nesting <= MaximumNesting || m_parser.fail(u"The expression is nested too deeply"_s);
+        }
+
+    private:
+        Parser &m_parser;
+    };
+
+    const QString &m_source;
+    const SensorResolver &m_resolve;
+    Expression &m_expression;
+    qsizetype m_position = 0;
+    int m_depth = 0;
+    int m_nesting = 0;
+};
+
+std::optional<Expression> Expression::compile(const QString &source, const SensorResolver &resolve, QString *errorMessage)
+{
+    Expression expression;
+    Parser parser(source, resolve, expression);
+    if (!parser.parse()) {
+        if (errorMessage) {
+            *errorMessage = parser.errorMessage;
+        }
+        return std::nullopt;
+    }
+    expression.m_stack.reserve(parser.maximumDepth);
+    return expression;
+}
+
+double Expression::evaluate() const
+{
+    constexpr double invalid = std::numeric_limits<double>::quiet_NaN();
+
+    m_stack.clear();
+    for (const auto &instruction : m_program) {
+        switch (instruction.operation) {
+        case Operation::Constant:
+            m_stack.push_back(instruction.constant);
+            break;
+        case Operation::Sensor: {
+            const auto &sensor = m_sources.at(instruction.operand);
+            if (!sensor) {
+                return invalid;
+            }
+            bool ok = false;
+            const double value = sensor->value().toDouble(&ok);
+            if (!ok) {
+                return invalid;
+            }
+            m_stack.push_back(value);
+            break;
+        }
+        case Operation::Negate:
+            m_stack.back() = -m_stack.back();
+            break;
+        case Operation::Add:
+        case Operation::Subtract:
+        case Operation::Multiply:
+        case Operation::Divide: {
+            const double right = m_stack.back();
+            m_stack.pop_back();
+            double &left = m_stack.back();
+            if (instruction.operation == Operation::Add) {
+                left += right;
+            } else if (instruction.operation == Operation::Subtract) {
+                left -= right;
+            } else if (instruction.operation == Operation::Multiply) {
+                left *= right;
+            } else {
+                left = right != 0.0 ? left / right : invalid;
+            }
+            break;
+        }
+        case Operation::Minimum:
+        case Operation::Maximum:
+        case Operation::Sum:
+        case Operation::Average: {
+            const auto first = m_stack.end() - instruction.operand;
+            double result;
+            if (instruction.operation == Operation::Minimum) {
+                result = *std::min_element(first, m_stack.end());
+            } else if (instruction.operation == Operation::Maximum) {
+                result = *std::max_element(first, m_stack.end());
+            } else {
+                result = std::accumulate(first, m_stack.end(), 0.0);
+                if (instruction.operation == Operation::Average) {
+                    result /= instruction.operand;
+                }
+            }
+            m_stack.erase(first, m_stack.end());
+            m_stack.push_back(result);
+            break;
+        }
+        }
+    }
+    return m_stack.empty() ? invalid : m_stack.back();
+}
+
+QList<KSysGuard::SensorProperty *> Expression::sources() const
+{
+    QList<KSysGuard::SensorProperty *> result;
+    result.reserve(m_sources.size());
+    for (const auto &sensor : m_sources) {
+        if (sensor) {
+            result.append(sensor);
+        }
+    }
+    return result;
+}
+
+bool Expression::replaceSource(KSysGuard::SensorProperty *sensor)
+{
+    const auto index = m_sourcePaths.indexOf(sensor->path());
+    if (index < 0) {
+        return false;
+    }
+    m_sources[index] = sensor;
+    return true;
+}
@@ -0,0 +1,93 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+namespace KSysGuard
+{
+    class SensorProperty;
+}
+
+/**
+ * A small arithmetic expression over sensor values.
+ *
+ * Supported are numbers, sensor paths, the operators + - * / with the usual
+ * precedence, parentheses and the functions min(), max(), sum() and avg() taking
+ * any number of arguments. Sensor paths consisting of anything but letters, digits,
+ * '_', '.' and '/' need to be put in double quotes, for example
+ * "lmsensors/k10temp-pci-00c3/temp1". As '/' is part of sensor paths, a division
+ * needs whitespace around the operator. Parentheses, function calls and unary minus
+ * can be nested 64 levels deep.
+ *
+ * The expression is compiled once into a flat program in reverse polish notation
+ * that refers to the source sensors directly, so evaluating it does not involve
+ * any parsing or lookups.
+ */
+class Expression
+{
+public:
+    using SensorResolver = std::function<KSysGuard::SensorProperty *(const QString &path)>;
+
+    /**
+     * Compiles @p source, using @p resolve to look up the sensors it refers to.
+     * Returns an empty optional and fills @p errorMessage if the expression is invalid.
+     */
+    static std::optional<Expression> compile(const QString &source, const SensorResolver &resolve, QString *errorMessage = nullptr);
+
+    /**
+     * Evaluates the expression with the current values of the source sensors.
+     * Returns NaN if any of the sources is gone or has no numeric value.
+     */
+    double evaluate() const;
+
+    QList<KSysGuard::SensorProperty *> sources() const;
+
+    /**
+     * Makes the expression refer to @p sensor instead of an earlier sensor with the same
+     * path, like after the provider of the sources was reloaded.
+     * Returns whether the expression refers to that path.
+     */
+    bool replaceSource(KSysGuard::SensorProperty *sensor);
+
+private:
+    enum class Operation {
+        Constant,
+        Sensor,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Negate,
+        Minimum,
+        Maximum,
+        Sum,
+        Average,
+    };
+
+    struct Instruction {
+        Operation operation;
+        // Index into m_sources for Sensor, argument count for functions
+        int operand = 0;
+        double constant = 0.0;
+    };
+
+    class Parser;
+
+    std::vector<Instruction> m_program;
+    QList<QPointer<KSysGuard::SensorProperty>> m_sources;
+    // Parallel to m_sources
+    QStringList m_sourcePaths;
+    mutable std::vector<double> m_stack;
+};
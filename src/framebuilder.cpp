@@ -0,0 +1,254 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "framebuilder.h"
+
+#include <QDBusArgument>
+#include <QDateTime>
+
+#include <systemstats/SensorInfo.h>
+#include <systemstats/SensorProperty.h>
+
+QDBusArgument &operator<<(QDBusArgument &argument, const FrameValues &values)
+{
+    argument.beginArray(qMetaTypeId<KSysGuard::SensorData>());
+    if (values.builder) {
+        for (int index : values.indices) {
+            argument.beginStructure();
+            argument << values.builder->path(index) << QDBusVariant(values.builder->value(index));
+            argument.endStructure();
+        }
+    }
+    argument.endArray();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, FrameValues &values)
+{
+    Q_UNUSED(values)
+    argument.beginArray();
+    while (!argument.atEnd()) {
+        KSysGuard::SensorData data;
+        argument >> data;
+    }
+    argument.endArray();
+    return argument;
+}
+
+FrameBuilder::FrameBuilder(QObject *parent)
+    : QObject(parent)
+{
+}
+
+FrameBuilder::~FrameBuilder() = default;
+
+int FrameBuilder::addSensor(KSysGuard::SensorProperty *sensor)
+{
+    if (auto it = m_indices.constFind(sensor); it != m_indices.cend()) {
+        ++m_entries[*it].references;
+        return *it;
+    }
+
+    int index;
+    if (!m_freeIndices.isEmpty()) {
+        index = m_freeIndices.takeLast();
+    } else {
+        index = m_entries.size();
+        m_entries.emplace_back();
+        m_values.emplace_back();
+        m_otherValues.append(QVariant());
+    }
+
+    auto &entry = m_entries[index];
+    entry.sensor = sensor;
+    entry.path = sensor->path();
+    entry.references = 1;
+    entry.valueChanged = connect(sensor, &KSysGuard::SensorProperty::valueChanged, this, [this, index]() {
+        auto &entry = m_entries[index];
+        if (!entry.changed) {
+            entry.changed = true;
+            m_pending.append(index);
+        }
+    });
+    entry.destroyed = connect(sensor, &QObject::destroyed, this, [this, index]() {
+        release(index);
+    });
+    m_indices.insert(sensor, index);
+
+    store(index, sensor->value());
+    return index;
+}
+
+void FrameBuilder::removeSensor(KSysGuard::SensorProperty *sensor)
+{
+    const int index = indexOf(sensor);
+    if (index < 0) {
+        return;
+    }
+    if (--m_entries[index].references == 0) {
+        release(index);
+    }
+}
+
+int FrameBuilder::indexOf(KSysGuard::SensorProperty *sensor) const
+{
+    return m_indices.value(sensor, -1);
+}
+
+void FrameBuilder::release(int index)
+{
+    auto &entry = m_entries[index];
+    disconnect(entry.valueChanged);
+    disconnect(entry.destroyed);
+    m_indices.remove(entry.sensor);
+    if (entry.changed) {
+        m_pending.removeOne(index);
+    }
+    m_changed.removeOne(index);
+
+    entry = Entry{};
+    m_values[index] = Value{};
+    m_otherValues[index] = QVariant();
+    m_freeIndices.append(index);
+}
+
+void FrameBuilder::buildFrame()
+{
+    // Swapping keeps the capacity of both lists around for the next frames
+    m_changed.clear();
+    m_changed.swap(m_pending);
+
+    for (int index : std::as_const(m_changed)) {
+        auto &entry = m_entries[index];
+        entry.changed = false;
+        store(index, entry.sensor->value());
+    }
+
+    m_usedFrameValues = 0;
+    ++m_generation;
+    m_timestamp = QDateTime::currentMSecsSinceEpoch();
+}
+
+FrameValues &FrameBuilder::frameValues()
+{
+    if (m_usedFrameValues == m_frameValues.size()) {
+        m_frameValues.push_back(FrameValues{this, {}});
+    }
+    auto &values = m_frameValues[m_usedFrameValues++];
+    // Keeps the capacity, unless a message sent earlier still shares the list
+    values.indices.clear();
+    return values;
+}
+
+const QList<int> &FrameBuilder::changedSensors() const
+{
+    return m_changed;
+}
+
+quint64 FrameBuilder::generation() const
+{
+    return m_generation;
+}
+
+qint64 FrameBuilder::timestamp() const
+{
+    return m_timestamp;
+}
+
+int FrameBuilder::size() const
+{
+    return m_entries.size();
+}
+
+void FrameBuilder::store(int index, const QVariant &value)
+{
+    auto &stored = m_values[index];
+    stored.type = value.typeId();
+    switch (stored.type) {
+    case QMetaType::Double:
+        stored.real = *static_cast<const double *>(value.constData());
+        break;
+    case QMetaType::Float:
+        stored.real = *static_cast<const float *>(value.constData());
+        break;
+    case QMetaType::Int:
+        stored.integer = *static_cast<const int *>(value.constData());
+        break;
+    case QMetaType::LongLong:
+        stored.integer = *static_cast<const qlonglong *>(value.constData());
+        break;
+    case QMetaType::UInt:
+        stored.unsignedInteger = *static_cast<const uint *>(value.constData());
+        break;
+    case QMetaType::ULongLong:
+        stored.unsignedInteger = *static_cast<const qulonglong *>(value.constData());
+        break;
+    case QMetaType::UnknownType:
+        break;
+    default:
+        m_otherValues[index] = value;
+        break;
+    }
+}
+
+bool FrameBuilder::hasValue(int index) const
+{
+    return m_values[index].type != QMetaType::UnknownType;
+}
+
+int FrameBuilder::type(int index) const
+{
+    return m_values[index].type;
+}
+
+double FrameBuilder::toDouble(int index) const
+{
+    const auto &stored = m_values[index];
+    switch (stored.type) {
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return stored.real;
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        return stored.integer;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+        return stored.unsignedInteger;
+    default:
+        return m_otherValues[index].toDouble();
+    }
+}
+
+QVariant FrameBuilder::value(int index) const
+{
+    // Restore the original type so clients see the same D-Bus type as before
+    const auto &stored = m_values[index];
+    switch (stored.type) {
+    case QMetaType::Double:
+        return QVariant(stored.real);
+    case QMetaType::Float:
+        return QVariant(float(stored.real));
+    case QMetaType::Int:
+        return QVariant(int(stored.integer));
+    case QMetaType::LongLong:
+        return QVariant(qlonglong(stored.integer));
+    case QMetaType::UInt:
+        return QVariant(uint(stored.unsignedInteger));
+    case QMetaType::ULongLong:
+        return QVariant(qulonglong(stored.unsignedInteger));
+    case QMetaType::UnknownType:
+        return QVariant();
+    default:
+        return m_otherValues[index];
+    }
+}
+
+const QString &FrameBuilder::path(int index) const
+{
+    return m_entries[index].path;
+}
+
+#include "moc_framebuilder.cpp"
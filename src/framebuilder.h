@@ -0,0 +1,144 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QVariant>
+
+class QDBusArgument;
+
+namespace KSysGuard
+{
+    class SensorProperty;
+}
+
+class FrameBuilder;
+
+/**
+ * A list of sensor values of the current frame, referring to the values stored
+ * in a FrameBuilder.
+ *
+ * This is marshalled to D-Bus the same way as KSysGuard::SensorDataList, values
+ * are only converted to QVariant while writing the message.
+ */
+struct FrameValues {
+    const FrameBuilder *builder = nullptr;
+    QList<int> indices;
+};
+Q_DECLARE_METATYPE(FrameValues)
+
+QDBusArgument &operator<<(QDBusArgument &argument, const FrameValues &values);
+// Only ever sent, reading skips the values
+const QDBusArgument &operator>>(const QDBusArgument &argument, FrameValues &values);
+
+/**
+ * Collects the values of all sensors any client is interested in once per frame.
+ *
+ * Every sensor added gets a stable index that clients use to refer to it. Numeric
+ * values are stored unboxed in a contiguous array, so that reading them for every
+ * client does not involve QVariant.
+ */
+class FrameBuilder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FrameBuilder(QObject *parent = nullptr);
+    ~FrameBuilder() override;
+
+    /**
+     * Starts tracking @p sensor, sensors are reference counted.
+     * @return The index of the sensor.
+     */
+    int addSensor(KSysGuard::SensorProperty *sensor);
+    void removeSensor(KSysGuard::SensorProperty *sensor);
+    int indexOf(KSysGuard::SensorProperty *sensor) const;
+
+    /**
+     * Reads the values of all sensors that changed since the last frame.
+     */
+    void buildFrame();
+
+    /**
+     * The indices of the sensors that changed in the last frame.
+     */
+    const QList<int> &changedSensors() const;
+
+    /**
+     * Incremented by every call to buildFrame(), 0 before the first frame.
+     */
+    quint64 generation() const;
+    /**
+     * When the last frame was built, in milliseconds since the epoch.
+     */
+    qint64 timestamp() const;
+
+    /**
+     * An empty list of values to send for the current frame.
+     *
+     * The lists are reused for later frames, so once they have grown to the usual
+     * number of changed sensors, collecting the values of a frame does not allocate.
+     * The list is only valid until the next call to buildFrame().
+     */
+    FrameValues &frameValues();
+
+    /**
+     * The number of indices currently in use, including free ones.
+     */
+    int size() const;
+
+    bool hasValue(int index) const;
+    /**
+     * The QMetaType of the value at @p index.
+     */
+    int type(int index) const;
+    double toDouble(int index) const;
+    QVariant value(int index) const;
+    const QString &path(int index) const;
+
+private:
+    struct Value {
+        int type = QMetaType::UnknownType;
+        union {
+            double real = 0.0;
+            qint64 integer;
+            quint64 unsignedInteger;
+        };
+    };
+
+    struct Entry {
+        KSysGuard::SensorProperty *sensor = nullptr;
+        QString path;
+        int references = 0;
+        bool changed = false;
+        QMetaObject::Connection valueChanged;
+        QMetaObject::Connection destroyed;
+    };
+
+    void release(int index);
+    void store(int index, const QVariant &value);
+
+    std::vector<Entry> m_entries;
+    // Parallel to m_entries
+    std::vector<Value> m_values;
+    // Values that are not numeric, parallel to m_entries
+    QList<QVariant> m_otherValues;
+    QHash<KSysGuard::SensorProperty *, int> m_indices;
+    QList<int> m_freeIndices;
+    QList<int> m_pending;
+    QList<int> m_changed;
+    // Handed out by frameValues(), a deque so references stay valid when adding more
+    std::deque<FrameValues> m_frameValues;
+    std::size_t m_usedFrameValues = 0;
+    quint64 m_generation = 0;
+    qint64 m_timestamp = 0;
+};
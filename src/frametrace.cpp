@@ -0,0 +1,127 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "frametrace.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+using namespace Qt::StringLiterals;
+
+static quint32 currentThread()
+{
+    // Small ids are easier to tell apart in a trace viewer than native thread ids
+    static std::atomic<quint32> nextThread{1};
+    thread_local const quint32 thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return thread;
+}
+
+FrameTrace::FrameTrace(uint capacity)
+    : m_capacity(std::max(capacity, 1u))
+    , m_slots(std::make_unique<Slot[]>(m_capacity))
+{
+}
+
+FrameTrace::~FrameTrace() = default;
+
+bool FrameTrace::isEnabled() const
+{
+    return m_enabled.load(std::memory_order_relaxed);
+}
+
+void FrameTrace::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+quint32 FrameTrace::intern(const QString &name)
+{
+    auto it = m_nameIds.constFind(name);
+    if (it != m_nameIds.constEnd()) {
+        return *it;
+    }
+    const quint32 id = m_names.size();
+    m_names.append(name);
+    m_nameIds.insert(name, id);
+    return id;
+}
+
+void FrameTrace::record(quint32 name, Clock::time_point start, Clock::time_point end)
+{
+    const quint64 position = m_next.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = m_slots[position % m_capacity];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.thread.store(currentThread(), std::memory_order_relaxed);
+    slot.start.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count(), std::memory_order_relaxed);
+    slot.duration.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+    slot.sequence.store(position + 1, std::memory_order_release);
+}
+
+QByteArray FrameTrace::toJson() const
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    events.append(QJsonObject{
+        {u"name"_s, u"process_name"_s},
+        {u"ph"_s, u"M"_s},
+        {u"pid"_s, pid},
+        {u"args"_s, QJsonObject{{u"name"_s, u"ksystemstats"_s}}},
+    });
+
+    const quint64 end = m_next.load(std::memory_order_acquire);
+    const quint64 begin = end > m_capacity ? end - m_capacity : 0;
+    for (quint64 position = begin; position < end; ++position) {
+        const Slot &slot = m_slots[position % m_capacity];
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != position + 1) {
+            // Still being written or already overwritten
+            continue;
+        }
+        const quint32 name = slot.name.load(std::memory_order_relaxed);
+        const quint32 thread = slot.thread.load(std::memory_order_relaxed);
+        const qint64 start = slot.start.load(std::memory_order_relaxed);
+        const qint64 duration = slot.duration.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence || name >= quint32(m_names.size())) {
+            continue;
+        }
+
+        // Complete events, timestamps are in microseconds
+        events.append(QJsonObject{
+            {u"name"_s, m_names[name]},
+            {u"ph"_s, u"X"_s},
+            {u"pid"_s, pid},
+            {u"tid"_s, qint64(thread)},
+            {u"ts"_s, start / 1000.0},
+            {u"dur"_s, duration / 1000.0},
+        });
+    }
+
+    return QJsonDocument(QJsonObject{{u"traceEvents"_s, events}, {u"displayTimeUnit"_s, u"ms"_s}}).toJson(QJsonDocument::Compact);
+}
+
+FrameTrace::Span::Span(FrameTrace *trace, const QString &name)
+{
+    if (trace && trace->isEnabled()) {
+        m_trace = trace;
+        m_name = trace->intern(name);
+        m_start = Clock::now();
+    }
+}
+
+FrameTrace::Span::~Span()
+{
+    if (m_trace) {
+        m_trace->record(m_name, m_start, Clock::now());
+    }
+}
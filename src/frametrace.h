@@ -0,0 +1,93 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * Records how long the steps of a frame take, to examine slow frames in a trace viewer.
+ *
+ * Trace points are recorded into a fixed size ring, overwriting the oldest ones, and
+ * exported in the Chrome trace event format that chrome://tracing and Perfetto open.
+ * Recording takes no locks and does not allocate, while tracing is disabled a trace
+ * point only checks a flag.
+ */
+class FrameTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint DefaultCapacity = 65536;
+
+    explicit FrameTrace(uint capacity = DefaultCapacity);
+    ~FrameTrace();
+
+    FrameTrace(const FrameTrace &) = delete;
+    FrameTrace &operator=(const FrameTrace &) = delete;
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    /**
+     * The id to record trace points named @p name with. Only to be called from the
+     * main thread.
+     */
+    quint32 intern(const QString &name);
+
+    /**
+     * Records a trace point that started at @p start and ended at @p end. Safe to call
+     * from any thread.
+     */
+    void record(quint32 name, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * The trace points currently in the ring as Chrome trace event JSON.
+     */
+    QByteArray toJson() const;
+
+    /**
+     * Records the time from its creation to its destruction, if tracing is enabled.
+     */
+    class Span
+    {
+    public:
+        Span(FrameTrace *trace, const QString &name);
+        ~Span();
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        FrameTrace *m_trace = nullptr;
+        quint32 m_name = 0;
+        Clock::time_point m_start;
+    };
+
+private:
+    // Sequence is the position in the ring plus one once the slot is written and zero
+    // while writing, so readers can skip slots that are being overwritten
+    struct Slot {
+        std::atomic<quint64> sequence{0};
+        std::atomic<quint32> name{0};
+        std::atomic<quint32> thread{0};
+        std::atomic<qint64> start{0};
+        std::atomic<qint64> duration{0};
+    };
+
+    uint m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<quint64> m_next{0};
+    std::atomic<bool> m_enabled{false};
+    QList<QString> m_names;
+    QHash<QString, quint32> m_nameIds;
+};
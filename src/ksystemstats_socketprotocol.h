@@ -0,0 +1,59 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+/*
+ * Binary protocol of the Unix domain socket the daemon listens on when the
+ * "Enabled" entry of the [Socket] group of ksystemstatsrc is set. The socket is
+ * "$XDG_RUNTIME_DIR/ksystemstats" unless the "Path" entry says otherwise.
+ *
+ * All integers are little endian. Every message starts with a uint32 length of
+ * the rest of the message, followed by a uint8 type and the payload:
+ *
+ * Sent by the daemon:
+ *   HELLO      uint32 magic, uint32 version. Sent once after connecting.
+ *   HANDLES    uint32 count, count * uint32 handle. Answers SUBSCRIBE with a handle
+ *              for every path in the same order, 0 for sensors that do not exist.
+ *   FRAME      uint64 generation, int64 timestamp in milliseconds since the epoch,
+ *              uint32 count, count * (uint32 handle, uint8 value type, value).
+ *              Contains the sensors that changed since the last frame. Also sent
+ *              right after HANDLES with the current values of the new sensors.
+ *   REMOVED    uint32 count, count * uint32 handle. The sensors were removed,
+ *              their handles are not used again.
+ *
+ * Sent by clients:
+ *   SUBSCRIBE   uint32 count, count * (uint16 length, UTF-8 path)
+ *   UNSUBSCRIBE uint32 count, count * uint32 handle
+ *
+ * Values are either a double, an int64, an uint64 or a string as uint32 length
+ * followed by UTF-8. Clients that fall behind only get the latest values. Clients that
+ * keep sending requests while not reading the replies are disconnected.
+ */
+
+#ifndef KSYSTEMSTATS_SOCKETPROTOCOL_H
+#define KSYSTEMSTATS_SOCKETPROTOCOL_H
+
+#define KSYSTEMSTATS_SOCKET_MAGIC 0x5053534bu /* "KSSP" */
+#define KSYSTEMSTATS_SOCKET_VERSION 1u
+/* Longer messages from clients are a protocol error */
+#define KSYSTEMSTATS_SOCKET_MAXIMUM_MESSAGE_SIZE (1024u * 1024u)
+
+enum ksystemstats_socket_message {
+    KSYSTEMSTATS_SOCKET_SUBSCRIBE = 0x01,
+    KSYSTEMSTATS_SOCKET_UNSUBSCRIBE = 0x02,
+    KSYSTEMSTATS_SOCKET_HELLO = 0x80,
+    KSYSTEMSTATS_SOCKET_HANDLES = 0x81,
+    KSYSTEMSTATS_SOCKET_FRAME = 0x82,
+    KSYSTEMSTATS_SOCKET_REMOVED = 0x83,
+};
+
+enum ksystemstats_socket_value_type {
+    KSYSTEMSTATS_SOCKET_DOUBLE = 1,
+    KSYSTEMSTATS_SOCKET_INT64 = 2,
+    KSYSTEMSTATS_SOCKET_UINT64 = 3,
+    KSYSTEMSTATS_SOCKET_STRING = 4,
+};
+
+#endif
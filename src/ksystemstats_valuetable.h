@@ -0,0 +1,115 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+/*
+ * Layout of the shared memory table with the latest values of selected sensors.
+ *
+ * The daemon publishes the sensors listed in the "Sensors" entry of the
+ * [ValueTable] group of ksystemstatsrc in the POSIX shared memory object named
+ * by the "Name" entry, "/ksystemstats-<uid>" by default. Readers map it read
+ * only and poll it without any IPC or wakeups of the daemon.
+ *
+ * The object starts with a header, followed by capacity slots and capacity
+ * directory entries. The directory entry of a slot contains the path of its
+ * sensor. Slots are never reused for other sensors, so indexes can be cached
+ * as long as magic and version match. Every slot is protected by a seqlock:
+ * its sequence is odd while the daemon writes it.
+ *
+ * This header is plain C so consumers that are not written in C++ can use it.
+ */
+
+#ifndef KSYSTEMSTATS_VALUETABLE_H
+#define KSYSTEMSTATS_VALUETABLE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define KSYSTEMSTATS_VALUETABLE_MAGIC 0x5453534bu /* "KSST" */
+#define KSYSTEMSTATS_VALUETABLE_VERSION 1u
+#define KSYSTEMSTATS_VALUETABLE_PATH_SIZE 128
+
+struct ksystemstats_valuetable_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    /* Slots in use, only grows. Updated after the directory entry was written. */
+    uint32_t slot_count;
+    /* The frame last written and when it was taken, in milliseconds since the epoch */
+    uint64_t generation;
+    int64_t timestamp;
+};
+
+struct ksystemstats_valuetable_slot {
+    uint32_t sequence;
+    /* 0 while the sensor has no value or after it was removed */
+    uint32_t valid;
+    int64_t timestamp;
+    double value;
+    uint64_t reserved;
+};
+
+struct ksystemstats_valuetable_entry {
+    /* Null terminated */
+    char path[KSYSTEMSTATS_VALUETABLE_PATH_SIZE];
+};
+
+static inline uint64_t ksystemstats_valuetable_size(uint32_t capacity)
+{
+    return sizeof(struct ksystemstats_valuetable_header)
+        + (uint64_t)capacity * (sizeof(struct ksystemstats_valuetable_slot) + sizeof(struct ksystemstats_valuetable_entry));
+}
+
+static inline const struct ksystemstats_valuetable_slot *ksystemstats_valuetable_slots(const struct ksystemstats_valuetable_header *header)
+{
+    return (const struct ksystemstats_valuetable_slot *)(header + 1);
+}
+
+static inline const struct ksystemstats_valuetable_entry *ksystemstats_valuetable_directory(const struct ksystemstats_valuetable_header *header)
+{
+    return (const struct ksystemstats_valuetable_entry *)(ksystemstats_valuetable_slots(header) + header->capacity);
+}
+
+/* Returns the slot of the sensor with path, or -1 if it is not published (yet). */
+static inline int ksystemstats_valuetable_find(const struct ksystemstats_valuetable_header *header, const char *path)
+{
+    const uint32_t count = __atomic_load_n(&header->slot_count, __ATOMIC_ACQUIRE);
+    const struct ksystemstats_valuetable_entry *directory = ksystemstats_valuetable_directory(header);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (strncmp(directory[i].path, path, KSYSTEMSTATS_VALUETABLE_PATH_SIZE) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Reads a consistent value of the slot at index. Returns 1 and sets value and
+ * timestamp if the sensor has a value, 0 otherwise.
+ */
+static inline int ksystemstats_valuetable_read(const struct ksystemstats_valuetable_header *header, int index, double *value, int64_t *timestamp)
+{
+    const struct ksystemstats_valuetable_slot *slot = ksystemstats_valuetable_slots(header) + index;
+    uint32_t before;
+    uint32_t after;
+    uint32_t valid;
+    do {
+        before = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1u) {
+            continue;
+        }
+        valid = __atomic_load_n(&slot->valid, __ATOMIC_RELAXED);
+        __atomic_load(&slot->value, value, __ATOMIC_RELAXED);
+        *timestamp = __atomic_load_n(&slot->timestamp, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+        if (before == after) {
+            break;
+        }
+    } while (1);
+    return valid != 0;
+}
+
+#endif
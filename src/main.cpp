@@ -7,11 +7,13 @@
 
 #include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QDBusConnection>
 
 #include <KAboutData>
 #include <KCrash>
 
 #include "daemon.h"
+#include "systemproxy.h"
 #include "version.h"
 
 int main(int argc, char **argv)
@@ -27,14 +29,28 @@ int main(int argc, char **argv)
     QCommandLineParser parser;
     parser.addOption(QCommandLineOption(QStringLiteral("replace"), QStringLiteral("Replace the running instance")));
     parser.addOption({QStringLiteral("remain"), QStringLiteral("Do not quit when last client has disconnected")});
+    parser.addOption({QStringLiteral("system"), QStringLiteral("Run as system service serving all users on the system bus")});
     parser.addHelpOption();
     parser.process(app);
 
-    Daemon d;
-    if (!d.init(parser.isSet(QStringLiteral("replace")) ? Daemon::ReplaceIfRunning::Replace : Daemon::ReplaceIfRunning::DoNotReplace)) {
+    const auto replace = parser.isSet(QStringLiteral("replace")) ? Daemon::ReplaceIfRunning::Replace : Daemon::ReplaceIfRunning::DoNotReplace;
+    const bool system = parser.isSet(QStringLiteral("system"));
+
+    // Sessions only forward to the system service when it runs, instead of updating the sensors once more
+    if (!system && SystemProxy::isSystemInstanceRunning()) {
+        SystemProxy proxy;
+        if (!proxy.init(replace)) {
+            return 1;
+        }
+        proxy.setQuitOnLastClientDisconnect(!parser.isSet(QStringLiteral("remain")));
+        return app.exec();
+    }
+
+    Daemon d(system ? QDBusConnection::systemBus() : QDBusConnection::sessionBus());
+    if (!d.init(replace)) {
         return 1;
     }
 
-    d.setQuitOnLastClientDisconnect(!parser.isSet(QStringLiteral("remain")));
+    d.setQuitOnLastClientDisconnect(!system && !parser.isSet(QStringLiteral("remain")));
     return app.exec();
 }
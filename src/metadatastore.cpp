@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "metadatastore.h"
+
+#include <systemstats/SensorObject.h>
+#include <systemstats/SensorProperty.h>
+
+void MetaDataStore::add(KSysGuard::SensorObject *object)
+{
+    const auto sensors = object->sensors();
+    for (auto sensor : sensors) {
+        add(sensor);
+    }
+}
+
+void MetaDataStore::add(KSysGuard::SensorProperty *sensor)
+{
+    const KSysGuard::SensorInfo info = sensor->info();
+
+    // Only replace strings that are not shared yet, setting them notifies subscribers
+    auto isShared = [](const QString &stored, const QString &string) {
+        return stored.constData() == string.constData();
+    };
+    if (const auto &name = intern(info.name); !isShared(name, info.name)) {
+        sensor->setName(name);
+    }
+    if (const auto &shortName = intern(info.shortName); !isShared(shortName, info.shortName)) {
+        sensor->setShortName(shortName);
+    }
+    if (const auto &description = intern(info.description); !isShared(description, info.description)) {
+        sensor->setDescription(description);
+    }
+    if (const auto &prefix = intern(info.prefix); !isShared(prefix, info.prefix)) {
+        sensor->setPrefix(prefix);
+    }
+}
+
+void MetaDataStore::prune()
+{
+    // Sensors share the data of the stored strings, so unused ones are not shared anymore
+    m_strings.removeIf([](const QString &string) {
+        return string.isDetached();
+    });
+}
+
+qsizetype MetaDataStore::size() const
+{
+    return m_strings.size();
+}
+
+const QString &MetaDataStore::intern(const QString &string)
+{
+    // Empty strings do not allocate anyway
+    if (string.isEmpty()) {
+        return string;
+    }
+    return *m_strings.insert(string);
+}
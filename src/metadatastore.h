@@ -0,0 +1,51 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QSet>
+#include <QString>
+
+namespace KSysGuard
+{
+    class SensorObject;
+    class SensorProperty;
+}
+
+/**
+ * Keeps a single copy of the metadata strings shared by many sensors.
+ *
+ * Providers build names and descriptions with i18nc() for every object, so a
+ * machine with many cores, disks or hardware sensors ends up with thousands of
+ * separately allocated copies of "System Usage" and the like. Once a sensor was
+ * added, its strings are replaced by the stored equal string, so all copies
+ * share the same data and the duplicates are freed.
+ */
+class MetaDataStore
+{
+public:
+    void add(KSysGuard::SensorObject *object);
+    void add(KSysGuard::SensorProperty *sensor);
+
+    /**
+     * Drops the strings that are not used by any sensor anymore, like after their
+     * sensors were destroyed.
+     */
+    void prune();
+
+    /**
+     * The number of distinct strings stored.
+     */
+    qsizetype size() const;
+
+private:
+    /**
+     * Returns the stored string equal to @p string, storing it first if needed.
+     */
+    const QString &intern(const QString &string);
+
+    QSet<QString> m_strings;
+};
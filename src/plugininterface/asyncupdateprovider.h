@@ -0,0 +1,39 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QFuture>
+#include <QtPlugin>
+
+/**
+ * Interface for sensor plugins that need to wait for I/O to update their sensors.
+ *
+ * A plugin implements this in addition to KSysGuard::SensorPlugin and lists it with
+ * Q_INTERFACES(AsyncUpdateProvider). The daemon still calls SensorPlugin::update() for
+ * every frame, for the values that can be read right away, and then updateAsync() unless
+ * the previous asynchronous update did not finish yet. It starts the updates of all
+ * plugins first and then waits for the returned futures, up to a deadline, before
+ * sending the frame. Values that are set after the deadline are sent with the next frame
+ * instead. An update that does not finish within a few seconds is considered hanging,
+ * it counts against the plugin's update budget and a new one is started.
+ *
+ * Sensor values still need to be set on the main thread, before the future finishes.
+ */
+class AsyncUpdateProvider
+{
+public:
+    virtual ~AsyncUpdateProvider() = default;
+
+    /**
+     * Starts updating the sensors of the plugin.
+     * @return A future that finishes once all values were set.
+     */
+    virtual QFuture<void> updateAsync() = 0;
+};
+
+#define AsyncUpdateProvider_iid "org.kde.ksystemstats.AsyncUpdateProvider/1"
+Q_DECLARE_INTERFACE(AsyncUpdateProvider, AsyncUpdateProvider_iid)
@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QtPlugin>
+
+/**
+ * Interface for sensor plugins whose sensors can be sampled in bursts.
+ *
+ * Bursts sample a few sensors much more often than frames are sent. Plugins that compute
+ * values over the time since their previous update, like rates, would compute them over
+ * a few milliseconds instead, and subscribers would get those values with the next frame.
+ * So only sensors of plugins that implement this, listed with
+ * Q_INTERFACES(BurstSampleProvider), can be part of a burst. The same goes for
+ * unsubscribed sensors asked for with sensorData(), only these plugins are updated
+ * before the reply.
+ */
+class BurstSampleProvider
+{
+public:
+    virtual ~BurstSampleProvider() = default;
+
+    /**
+     * Updates the sensors for a burst sample. This must not change the values that
+     * subscribers get with the next frame in other ways than a normal update would.
+     */
+    virtual void sampleBurst() = 0;
+};
+
+#define BurstSampleProvider_iid "org.kde.ksystemstats.BurstSampleProvider/1"
+Q_DECLARE_INTERFACE(BurstSampleProvider, BurstSampleProvider_iid)
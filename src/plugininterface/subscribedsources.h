@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <algorithm>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+#include <systemstats/SensorProperty.h>
+
+/**
+ * Tracks which sources of a plugin are needed by subscribed properties.
+ *
+ * A source is whatever a plugin reads in one go, like a file or a sysctl. The plugin
+ * registers which properties get their value from which source and, when updating,
+ * only reads the sources that have at least one subscribed property.
+ */
+template<typename Source>
+class SubscribedSources
+{
+public:
+    SubscribedSources() = default;
+    ~SubscribedSources()
+    {
+        for (const auto &connection : std::as_const(m_connections)) {
+            QObject::disconnect(connection);
+        }
+    }
+
+    SubscribedSources(const SubscribedSources &) = delete;
+    SubscribedSources &operator=(const SubscribedSources &) = delete;
+
+    /**
+     * Marks @p property as being read from @p source. A property can be read from
+     * more than one source.
+     */
+    void addProperty(const Source &source, KSysGuard::SensorProperty *property)
+    {
+        if (property->isSubscribed()) {
+            ++m_counts[source];
+        }
+        m_connections.append(QObject::connect(property, &KSysGuard::SensorProperty::subscribedChanged, property, [this, source](bool subscribed) {
+            m_counts[source] += subscribed ? 1 : -1;
+        }));
+    }
+
+    /**
+     * Whether any property read from @p source is subscribed.
+     */
+    bool isNeeded(const Source &source) const
+    {
+        return m_counts.value(source) > 0;
+    }
+
+    bool isAnyNeeded() const
+    {
+        return std::any_of(m_counts.cbegin(), m_counts.cend(), [](int count) {
+            return count > 0;
+        });
+    }
+
+private:
+    // The number of subscribed properties per source
+    QHash<Source, int> m_counts;
+    QList<QMetaObject::Connection> m_connections;
+};
+
+/**
+ * Updates the properties in @p properties that are subscribed. For properties that
+ * read their own source, like KSysGuard::SysFsSensor.
+ */
+template<typename Properties>
+void updateSubscribed(const Properties &properties)
+{
+    for (auto property : properties) {
+        if (property && property->isSubscribed()) {
+            property->update();
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "quantilesketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Magnitudes below this are counted as zero, above the maximum they end up in the last bucket
+constexpr double MinimumMagnitude = 1e-4;
+constexpr double MaximumMagnitude = 1e13;
+constexpr int SliceCount = 10;
+
+QuantileSketch::QuantileSketch(std::chrono::milliseconds window, double relativeAccuracy)
+    : m_gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy))
+    , m_logGamma(std::log(m_gamma))
+    , m_indexOffset(int(std::ceil(std::log(MinimumMagnitude) / m_logGamma)))
+    , m_bucketCount(int(std::ceil(std::log(MaximumMagnitude) / m_logGamma)) - m_indexOffset + 1)
+    , m_sliceDuration(std::max(window / SliceCount, std::chrono::milliseconds{1}))
+    , m_slices(SliceCount)
+{
+    m_window.positive.resize(m_bucketCount);
+    for (auto &slice : m_slices) {
+        slice.positive.resize(m_bucketCount);
+    }
+}
+
+void QuantileSketch::add(double value, Clock::time_point now)
+{
+    if (!std::isfinite(value)) {
+        return;
+    }
+    advance(now);
+
+    auto &slice = m_slices[m_currentSlice];
+    const double magnitude = std::abs(value);
+    if (magnitude < MinimumMagnitude) {
+        ++slice.zero;
+        ++m_window.zero;
+    } else if (value > 0) {
+        const int index = bucketIndex(magnitude);
+        ++slice.positive[index];
+        ++m_window.positive[index];
+    } else {
+        if (slice.negative.empty()) {
+            slice.negative.resize(m_bucketCount);
+        }
+        if (m_window.negative.empty()) {
+            m_window.negative.resize(m_bucketCount);
+        }
+        const int index = bucketIndex(magnitude);
+        ++slice.negative[index];
+        ++m_window.negative[index];
+    }
+    ++slice.total;
+    ++m_window.total;
+}
+
+double QuantileSketch::quantile(double q) const
+{
+    if (m_window.total == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const quint64 rank = quint64(std::clamp(q, 0.0, 1.0) * double(m_window.total - 1));
+    quint64 seen = 0;
+    // Walk from the smallest value up, that is from the largest negative magnitude
+    for (int index = int(m_window.negative.size()) - 1; index >= 0; --index) {
+        seen += m_window.negative[index];
+        if (seen > rank) {
+            return -bucketValue(index);
+        }
+    }
+    seen += m_window.zero;
+    if (seen > rank) {
+        return 0.0;
+    }
+    for (int index = 0; index < m_bucketCount; ++index) {
+        seen += m_window.positive[index];
+        if (seen > rank) {
+            return bucketValue(index);
+        }
+    }
+    return bucketValue(m_bucketCount - 1);
+}
+
+double QuantileSketch::rank(double value) const
+{
+    if (m_window.total == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    quint64 below = 0;
+    const double magnitude = std::abs(value);
+    if (magnitude < MinimumMagnitude) {
+        for (auto count : m_window.negative) {
+            below += count;
+        }
+        below += m_window.zero;
+    } else if (value > 0) {
+        for (auto count : m_window.negative) {
+            below += count;
+        }
+        below += m_window.zero;
+        const int last = bucketIndex(magnitude);
+        for (int index = 0; index <= last; ++index) {
+            below += m_window.positive[index];
+        }
+    } else if (!m_window.negative.empty()) {
+        const int first = bucketIndex(magnitude);
+        for (int index = first; index < m_bucketCount; ++index) {
+            below += m_window.negative[index];
+        }
+    }
+    return double(below) / double(m_window.total);
+}
+
+quint64 QuantileSketch::count() const
+{
+    return m_window.total;
+}
+
+void QuantileSketch::advance(Clock::time_point now)
+{
+    if (!m_started) {
+        m_sliceStart = now;
+        m_started = true;
+        return;
+    }
+
+    // Only drop as many slices as there are, a longer gap empties the whole window
+    for (int i = 0; i < SliceCount && now - m_sliceStart >= m_sliceDuration; ++i) {
+        m_currentSlice = (m_currentSlice + 1) % SliceCount;
+        subtract(m_window, m_slices[m_currentSlice]);
+        m_sliceStart += m_sliceDuration;
+    }
+    if (now - m_sliceStart >= m_sliceDuration) {
+        m_sliceStart = now;
+    }
+}
+
+int QuantileSketch::bucketIndex(double magnitude) const
+{
+    const int index = int(std::ceil(std::log(magnitude) / m_logGamma)) - m_indexOffset;
+    return std::clamp(index, 0, m_bucketCount - 1);
+}
+
+double QuantileSketch::bucketValue(int index) const
+{
+    // The value in the middle of the bucket in terms of relative error
+    return 2.0 * std::pow(m_gamma, index + m_indexOffset) / (m_gamma + 1.0);
+}
+
+void QuantileSketch::subtract(Counts &from, Counts &slice)
+{
+    if (slice.total == 0) {
+        return;
+    }
+    for (int index = 0; index < m_bucketCount; ++index) {
+        from.positive[index] -= slice.positive[index];
+    }
+    std::fill(slice.positive.begin(), slice.positive.end(), 0);
+    if (!slice.negative.empty()) {
+        for (int index = 0; index < m_bucketCount; ++index) {
+            from.negative[index] -= slice.negative[index];
+        }
+        std::fill(slice.negative.begin(), slice.negative.end(), 0);
+    }
+    from.zero -= slice.zero;
+    from.total -= slice.total;
+    slice.zero = 0;
+    slice.total = 0;
+}
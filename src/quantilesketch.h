@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <QtGlobal>
+
+/**
+ * Estimates quantiles of the values added during a sliding time window.
+ *
+ * This is a DDSketch: values are counted in logarithmically sized buckets, so every
+ * estimate is within the relative accuracy of the real value, independent of the
+ * distribution. Adding a value is a single increment. The window is split into
+ * slices whose counts are dropped as a whole once they fall out of the window.
+ */
+class QuantileSketch
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit QuantileSketch(std::chrono::milliseconds window, double relativeAccuracy = 0.01);
+
+    void add(double value, Clock::time_point now);
+
+    /**
+     * The estimated value at quantile @p q, between 0 and 1, of the values in the window.
+     * Returns NaN if the window is empty.
+     */
+    double quantile(double q) const;
+    /**
+     * The fraction of values in the window that are less than or equal to @p value.
+     * Returns NaN if the window is empty.
+     */
+    double rank(double value) const;
+    quint64 count() const;
+
+    /**
+     * Drops slices that are older than the window, relative to @p now.
+     */
+    void advance(Clock::time_point now);
+
+private:
+    struct Counts {
+        std::vector<quint32> positive;
+        // Only allocated once a negative value was added
+        std::vector<quint32> negative;
+        quint64 zero = 0;
+        quint64 total = 0;
+    };
+
+    int bucketIndex(double magnitude) const;
+    double bucketValue(int index) const;
+    void subtract(Counts &from, Counts &slice);
+
+    double m_gamma;
+    double m_logGamma;
+    int m_indexOffset;
+    int m_bucketCount;
+
+    std::chrono::milliseconds m_sliceDuration;
+    std::vector<Counts> m_slices;
+    std::size_t m_currentSlice = 0;
+    Clock::time_point m_sliceStart;
+    bool m_started = false;
+    // The sum of all slices, kept up to date so queries do not need to merge them
+    Counts m_window;
+};
@@ -0,0 +1,146 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "sensorindex.h"
+
+#include <systemstats/SensorObject.h>
+#include <systemstats/SensorProperty.h>
+
+SensorIndex::~SensorIndex()
+{
+    for (const auto &entry : std::as_const(m_sensors)) {
+        QObject::disconnect(entry.infoChanged);
+        QObject::disconnect(entry.destroyed);
+    }
+}
+
+void SensorIndex::add(KSysGuard::SensorObject *object)
+{
+    const auto sensors = object->sensors();
+    for (auto sensor : sensors) {
+        add(sensor);
+    }
+}
+
+void SensorIndex::add(KSysGuard::SensorProperty *sensor)
+{
+    if (m_sensors.contains(sensor)) {
+        return;
+    }
+
+    Entry &entry = m_sensors[sensor];
+    insertKeys(sensor, entry);
+    entry.infoChanged = QObject::connect(sensor, &KSysGuard::SensorProperty::sensorInfoChanged, [this, sensor]() {
+        Entry &entry = m_sensors[sensor];
+        const KSysGuard::SensorInfo info = sensor->info();
+        if (info.unit != entry.unit || info.variantType != entry.type) {
+            removeKeys(sensor, entry);
+            insertKeys(sensor, entry);
+        }
+    });
+    // The sensor can not be asked for its info anymore, the entry knows its keys
+    entry.destroyed = QObject::connect(sensor, &QObject::destroyed, [this, sensor]() {
+        forget(sensor);
+    });
+}
+
+void SensorIndex::remove(KSysGuard::SensorObject *object)
+{
+    const auto sensors = object->sensors();
+    for (auto sensor : sensors) {
+        remove(sensor);
+    }
+}
+
+void SensorIndex::remove(KSysGuard::SensorProperty *sensor)
+{
+    forget(sensor);
+}
+
+QList<KSysGuard::SensorProperty *> SensorIndex::find(const Filter &filter) const
+{
+    // Start from the smallest indexed set, the remaining criteria are checked per sensor
+    const QSet<KSysGuard::SensorProperty *> *candidates = nullptr;
+    static const QSet<KSysGuard::SensorProperty *> none;
+    if (filter.unit) {
+        auto it = m_byUnit.constFind(*filter.unit);
+        candidates = it != m_byUnit.cend() ? &*it : &none;
+    }
+    if (filter.type) {
+        auto it = m_byType.constFind(*filter.type);
+        const auto byType = it != m_byType.cend() ? &*it : &none;
+        if (!candidates || byType->size() < candidates->size()) {
+            candidates = byType;
+        }
+    }
+
+    const QString containerPrefix = filter.container.isEmpty() ? QString() : filter.container + QLatin1Char('/');
+    QList<KSysGuard::SensorProperty *> result;
+    auto check = [&](KSysGuard::SensorProperty *sensor, const Entry &entry) {
+        if ((filter.unit && entry.unit != *filter.unit) || (filter.type && entry.type != *filter.type)) {
+            return;
+        }
+        if (!containerPrefix.isEmpty() && !sensor->path().startsWith(containerPrefix)) {
+            return;
+        }
+        if (!filter.name.isEmpty() && !sensor->info().name.contains(filter.name, Qt::CaseInsensitive)) {
+            return;
+        }
+        result.append(sensor);
+    };
+
+    if (candidates) {
+        for (auto sensor : *candidates) {
+            check(sensor, *m_sensors.constFind(sensor));
+        }
+    } else {
+        for (auto it = m_sensors.cbegin(); it != m_sensors.cend(); ++it) {
+            check(it.key(), it.value());
+        }
+    }
+    return result;
+}
+
+qsizetype SensorIndex::size() const
+{
+    return m_sensors.size();
+}
+
+void SensorIndex::insertKeys(KSysGuard::SensorProperty *sensor, Entry &entry)
+{
+    const KSysGuard::SensorInfo info = sensor->info();
+    entry.unit = info.unit;
+    entry.type = info.variantType;
+    m_byUnit[entry.unit].insert(sensor);
+    m_byType[entry.type].insert(sensor);
+}
+
+void SensorIndex::removeKeys(KSysGuard::SensorProperty *sensor, const Entry &entry)
+{
+    auto removeFrom = [sensor](auto &index, auto key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->remove(sensor);
+            if (it->isEmpty()) {
+                index.erase(it);
+            }
+        }
+    };
+    removeFrom(m_byUnit, entry.unit);
+    removeFrom(m_byType, entry.type);
+}
+
+void SensorIndex::forget(KSysGuard::SensorProperty *sensor)
+{
+    auto it = m_sensors.find(sensor);
+    if (it == m_sensors.end()) {
+        return;
+    }
+    QObject::disconnect(it->infoChanged);
+    QObject::disconnect(it->destroyed);
+    removeKeys(sensor, *it);
+    m_sensors.erase(it);
+}
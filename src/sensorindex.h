@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <optional>
+
+#include <QHash>
+#include <QList>
+#include <QMetaObject>
+#include <QMetaType>
+#include <QSet>
+#include <QString>
+
+#include <systemstats/SensorInfo.h>
+
+namespace KSysGuard
+{
+    class SensorObject;
+    class SensorProperty;
+}
+
+/**
+ * Indexes all registered sensors by unit and variant type.
+ *
+ * Clients looking for all temperatures or all rates would otherwise need to fetch
+ * the metadata of every sensor. The index follows changes to the metadata of the
+ * sensors and drops destroyed sensors by itself.
+ */
+class SensorIndex
+{
+public:
+    struct Filter {
+        std::optional<KSysGuard::Unit> unit;
+        std::optional<QMetaType::Type> type;
+        // Matches sensors of this container only if not empty
+        QString container;
+        // Case insensitive substring of the name if not empty
+        QString name;
+    };
+
+    SensorIndex() = default;
+    ~SensorIndex();
+    Q_DISABLE_COPY_MOVE(SensorIndex)
+
+    void add(KSysGuard::SensorObject *object);
+    void add(KSysGuard::SensorProperty *sensor);
+    void remove(KSysGuard::SensorObject *object);
+    void remove(KSysGuard::SensorProperty *sensor);
+
+    /**
+     * Returns all sensors matching every criterion set in @p filter.
+     */
+    QList<KSysGuard::SensorProperty *> find(const Filter &filter) const;
+
+    qsizetype size() const;
+
+private:
+    struct Entry {
+        KSysGuard::Unit unit;
+        QMetaType::Type type;
+        QMetaObject::Connection infoChanged;
+        QMetaObject::Connection destroyed;
+    };
+
+    void insertKeys(KSysGuard::SensorProperty *sensor, Entry &entry);
+    void removeKeys(KSysGuard::SensorProperty *sensor, const Entry &entry);
+    void forget(KSysGuard::SensorProperty *sensor);
+
+    QHash<KSysGuard::SensorProperty *, Entry> m_sensors;
+    QHash<KSysGuard::Unit, QSet<KSysGuard::SensorProperty *>> m_byUnit;
+    QHash<QMetaType::Type, QSet<KSysGuard::SensorProperty *>> m_byType;
+};
@@ -0,0 +1,382 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "socketserver.h"
+
+#include <cstring>
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QtEndian>
+
+#include <systemstats/SensorProperty.h>
+
+#include "daemon.h"
+#include "debug.h"
+#include "framebuilder.h"
+#include "ksystemstats_socketprotocol.h"
+
+using namespace Qt::StringLiterals;
+
+// Values of a client with more unsent data are held back, only the latest ones are sent once it caught up
+constexpr qint64 MaximumBacklog = 256 * 1024;
+
+namespace
+{
+template<typename T>
+void append(QByteArray &buffer, T value)
+{
+    const T littleEndian = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char *>(&littleEndian), sizeof(T));
+}
+
+void append(QByteArray &buffer, double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    append(buffer, bits);
+}
+
+/**
+ * Reads the payload of a message, any read past its end makes it invalid.
+ */
+class PayloadReader
+{
+public:
+    explicit PayloadReader(QByteArrayView payload)
+        : m_payload(payload)
+    {
+    }
+
+    template<typename T>
+    T read()
+    {
+        if (m_payload.size() < qsizetype(sizeof(T))) {
+            m_valid = false;
+            m_payload = {};
+            return T{};
+        }
+        const T value = qFromLittleEndian<T>(m_payload.data());
+        m_payload = m_payload.sliced(sizeof(T));
+        return value;
+    }
+
+    QByteArrayView readBytes(qsizetype size)
+    {
+        if (m_payload.size() < size) {
+            m_valid = false;
+            m_payload = {};
+            return {};
+        }
+        const auto bytes = m_payload.first(size);
+        m_payload = m_payload.sliced(size);
+        return bytes;
+    }
+
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+private:
+    QByteArrayView m_payload;
+    bool m_valid = true;
+};
+}
+
+SocketClient::SocketClient(Daemon *daemon, QLocalSocket *socket, QObject *parent)
+    : QObject(parent)
+    , m_daemon(daemon)
+    , m_socket(socket)
+{
+    m_socket->setParent(this);
+    connect(m_socket, &QLocalSocket::readyRead, this, &SocketClient::readMessages);
+
+    beginMessage(KSYSTEMSTATS_SOCKET_HELLO);
+    append(m_output, quint32(KSYSTEMSTATS_SOCKET_MAGIC));
+    append(m_output, quint32(KSYSTEMSTATS_SOCKET_VERSION));
+    endMessage();
+    flush();
+}
+
+SocketClient::~SocketClient()
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it) {
+        disconnect(it->destroyed);
+        frameBuilder->removeSensor(it.key());
+        it.key()->unsubscribe();
+    }
+}
+
+void SocketClient::sendFrame()
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    const auto &changed = frameBuilder->changedSensors();
+    for (int index : changed) {
+        if (index < int(m_handles.size()) && m_handles[index] != 0 && !m_pending[index]) {
+            m_pending[index] = true;
+            m_pendingIndices.append(index);
+        }
+    }
+
+    if (m_pendingIndices.isEmpty() || m_socket->bytesToWrite() > MaximumBacklog) {
+        return;
+    }
+    writeFrame();
+    flush();
+}
+
+void SocketClient::writeFrame()
+{
+    auto frameBuilder = m_daemon->frameBuilder();
+    beginMessage(KSYSTEMSTATS_SOCKET_FRAME);
+    append(m_output, frameBuilder->generation());
+    append(m_output, frameBuilder->timestamp());
+    const qsizetype countPosition = m_output.size();
+    append(m_output, quint32(0));
+
+    quint32 count = 0;
+    for (int index : std::as_const(m_pendingIndices)) {
+        m_pending[index] = false;
+        // Removed since it changed
+        const quint32 handle = m_handles[index];
+        if (handle == 0 || !frameBuilder->hasValue(index)) {
+            continue;
+        }
+        append(m_output, handle);
+        switch (frameBuilder->type(index)) {
+        case QMetaType::Double:
+        case QMetaType::Float:
+            append(m_output, quint8(KSYSTEMSTATS_SOCKET_DOUBLE));
+            append(m_output, frameBuilder->toDouble(index));
+            break;
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+            append(m_output, quint8(KSYSTEMSTATS_SOCKET_INT64));
+            append(m_output, qint64(frameBuilder->value(index).toLongLong()));
+            break;
+        case QMetaType::UInt:
+        case QMetaType::ULongLong:
+            append(m_output, quint8(KSYSTEMSTATS_SOCKET_UINT64));
+            append(m_output, quint64(frameBuilder->value(index).toULongLong()));
+            break;
+        default: {
+            const QByteArray string = frameBuilder->value(index).toString().toUtf8();
+            append(m_output, quint8(KSYSTEMSTATS_SOCKET_STRING));
+            append(m_output, quint32(string.size()));
+            m_output.append(string);
+            break;
+        }
+        }
+        ++count;
+    }
+    m_pendingIndices.clear();
+
+    if (count == 0) {
+        m_output.truncate(m_messageStart);
+        return;
+    }
+    qToLittleEndian(count, m_output.data() + countPosition);
+    endMessage();
+}
+
+void SocketClient::readMessages()
+{
+    m_input.append(m_socket->readAll());
+
+    QByteArrayView input = m_input;
+    while (input.size() >= qsizetype(sizeof(quint32))) {
+        const quint32 length = qFromLittleEndian<quint32>(input.data());
+        if (length == 0 || length > KSYSTEMSTATS_SOCKET_MAXIMUM_MESSAGE_SIZE) {
+            qCWarning(KSYSTEMSTATS_DAEMON) << "Socket client sent a message of invalid length" << length;
+            m_socket->abort();
+            return;
+        }
+        if (input.size() < qsizetype(sizeof(quint32) + length)) {
+            break;
+        }
+        // Replies are written whether the client reads them or not, so one that keeps sending
+        // requests without reading would grow the output without bound
+        if (m_socket->bytesToWrite() + m_output.size() > MaximumBacklog) {
+            qCWarning(KSYSTEMSTATS_DAEMON) << "Socket client does not read its replies, disconnecting";
+            m_socket->abort();
+            return;
+        }
+        const auto message = input.sliced(sizeof(quint32), length);
+        input = input.sliced(sizeof(quint32) + length);
+        if (!handleMessage(quint8(message.front()), message.sliced(1))) {
+            qCWarning(KSYSTEMSTATS_DAEMON) << "Socket client sent an invalid message of type" << quint8(message.front());
+            m_socket->abort();
+            return;
+        }
+    }
+    m_input.remove(0, m_input.size() - input.size());
+    flush();
+}
+
+bool SocketClient::handleMessage(quint8 type, QByteArrayView payload)
+{
+    switch (type) {
+    case KSYSTEMSTATS_SOCKET_SUBSCRIBE:
+        return subscribe(payload);
+    case KSYSTEMSTATS_SOCKET_UNSUBSCRIBE:
+        return unsubscribe(payload);
+    default:
+        return false;
+    }
+}
+
+bool SocketClient::subscribe(QByteArrayView payload)
+{
+    PayloadReader reader(payload);
+    const quint32 count = reader.read<quint32>();
+
+    auto frameBuilder = m_daemon->frameBuilder();
+    beginMessage(KSYSTEMSTATS_SOCKET_HANDLES);
+    append(m_output, count);
+    for (quint32 i = 0; i < count && reader.isValid(); ++i) {
+        const auto path = reader.readBytes(reader.read<quint16>());
+        auto sensor = reader.isValid() ? m_daemon->findSensor(QString::fromUtf8(path)) : nullptr;
+        if (!sensor) {
+            append(m_output, quint32(0));
+            continue;
+        }
+        if (auto existing = m_subscriptions.constFind(sensor); existing != m_subscriptions.cend()) {
+            append(m_output, existing->handle);
+            continue;
+        }
+
+        Subscription subscription;
+        subscription.handle = m_nextHandle++;
+        subscription.index = frameBuilder->addSensor(sensor);
+        subscription.destroyed = connect(sensor, &QObject::destroyed, this, [this, sensor]() {
+            // The frame builder releases the index of destroyed sensors by itself
+            const auto subscription = m_subscriptions.take(sensor);
+            m_sensors.remove(subscription.handle);
+            m_handles[subscription.index] = 0;
+            beginMessage(KSYSTEMSTATS_SOCKET_REMOVED);
+            append(m_output, quint32(1));
+            append(m_output, subscription.handle);
+            endMessage();
+            flush();
+        });
+        if (subscription.index >= int(m_handles.size())) {
+            m_handles.resize(frameBuilder->size(), 0);
+            m_pending.resize(frameBuilder->size(), false);
+        }
+        m_handles[subscription.index] = subscription.handle;
+        m_subscriptions.insert(sensor, subscription);
+        m_sensors.insert(subscription.handle, sensor);
+        sensor->subscribe();
+        append(m_output, subscription.handle);
+
+        // Current values are sent right away instead of with the next change
+        if (frameBuilder->hasValue(subscription.index) && !m_pending[subscription.index]) {
+            m_pending[subscription.index] = true;
+            m_pendingIndices.append(subscription.index);
+        }
+    }
+
+    if (!reader.isValid()) {
+        m_output.truncate(m_messageStart);
+        return false;
+    }
+    endMessage();
+    if (!m_pendingIndices.isEmpty()) {
+        writeFrame();
+    }
+    return true;
+}
+
+bool SocketClient::unsubscribe(QByteArrayView payload)
+{
+    PayloadReader reader(payload);
+    const quint32 count = reader.read<quint32>();
+    for (quint32 i = 0; i < count && reader.isValid(); ++i) {
+        const quint32 handle = reader.read<quint32>();
+        if (auto sensor = m_sensors.value(handle)) {
+            removeSubscription(sensor);
+        }
+    }
+    return reader.isValid();
+}
+
+void SocketClient::removeSubscription(KSysGuard::SensorProperty *sensor)
+{
+    const auto subscription = m_subscriptions.take(sensor);
+    disconnect(subscription.destroyed);
+    m_sensors.remove(subscription.handle);
+    m_handles[subscription.index] = 0;
+    m_daemon->frameBuilder()->removeSensor(sensor);
+    sensor->unsubscribe();
+}
+
+void SocketClient::beginMessage(quint8 type)
+{
+    m_messageStart = m_output.size();
+    append(m_output, quint32(0));
+    append(m_output, type);
+}
+
+void SocketClient::endMessage()
+{
+    const quint32 length = m_output.size() - m_messageStart - sizeof(quint32);
+    qToLittleEndian(length, m_output.data() + m_messageStart);
+}
+
+void SocketClient::flush()
+{
+    if (m_output.isEmpty()) {
+        return;
+    }
+    m_socket->write(m_output);
+    // Keeps the capacity for the next messages
+    m_output.truncate(0);
+}
+
+SocketServer::SocketServer(Daemon *daemon)
+    : QObject(daemon)
+    , m_daemon(daemon)
+    , m_server(new QLocalServer(this))
+{
+    connect(m_server, &QLocalServer::newConnection, this, [this]() {
+        while (auto socket = m_server->nextPendingConnection()) {
+            auto client = new SocketClient(m_daemon, socket, this);
+            m_clients.append(client);
+            connect(socket, &QLocalSocket::disconnected, client, [this, client]() {
+                m_clients.removeOne(client);
+                client->deleteLater();
+            });
+        }
+    });
+}
+
+SocketServer::~SocketServer()
+{
+    // Release their sensors while the frame builder still exists
+    qDeleteAll(m_clients);
+}
+
+bool SocketServer::listen(const QString &path, bool allowAllUsers)
+{
+    QLocalServer::removeServer(path);
+    m_server->setSocketOptions(allowAllUsers ? QLocalServer::WorldAccessOption : QLocalServer::UserAccessOption);
+    if (!m_server->listen(path)) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Could not listen on" << path << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void SocketServer::sendFrame()
+{
+    for (auto client : std::as_const(m_clients)) {
+        client->sendFrame();
+    }
+}
+
+#include "moc_socketserver.cpp"
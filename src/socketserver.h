@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+class Daemon;
+class QLocalServer;
+class QLocalSocket;
+
+namespace KSysGuard
+{
+    class SensorProperty;
+}
+
+/**
+ * A client connected through the Unix domain socket.
+ *
+ * The counterpart of Client for consumers that do not want to use D-Bus, see
+ * ksystemstats_socketprotocol.h for the protocol. Values come from the same
+ * frame builder, so serving them does not sample anything again.
+ */
+class SocketClient : public QObject
+{
+    Q_OBJECT
+public:
+    SocketClient(Daemon *daemon, QLocalSocket *socket, QObject *parent = nullptr);
+    ~SocketClient() override;
+
+    void sendFrame();
+
+private:
+    struct Subscription {
+        quint32 handle;
+        // Index of the sensor in the daemon's FrameBuilder
+        int index;
+        QMetaObject::Connection destroyed;
+    };
+
+    void readMessages();
+    bool handleMessage(quint8 type, QByteArrayView payload);
+    bool subscribe(QByteArrayView payload);
+    bool unsubscribe(QByteArrayView payload);
+    void removeSubscription(KSysGuard::SensorProperty *sensor);
+    // Writes the values of the pending sensors as FRAME
+    void writeFrame();
+    void beginMessage(quint8 type);
+    void endMessage();
+    void flush();
+
+    Daemon *m_daemon;
+    QLocalSocket *m_socket;
+    QByteArray m_input;
+    // Reused for all messages, written to the socket once per frame or request
+    QByteArray m_output;
+    qsizetype m_messageStart = 0;
+
+    QHash<KSysGuard::SensorProperty *, Subscription> m_subscriptions;
+    QHash<quint32, KSysGuard::SensorProperty *> m_sensors;
+    quint32 m_nextHandle = 1;
+    // Per FrameBuilder index, 0 if not subscribed
+    std::vector<quint32> m_handles;
+    // Changed sensors not sent yet because the client fell behind, each listed once
+    QList<int> m_pendingIndices;
+    std::vector<bool> m_pending;
+};
+
+/**
+ * Listens on a Unix domain socket and serves the connected SocketClients.
+ */
+class SocketServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SocketServer(Daemon *daemon);
+    ~SocketServer() override;
+
+    /**
+     * @param allowAllUsers Whether other users may connect, for the system wide instance.
+     */
+    bool listen(const QString &path, bool allowAllUsers);
+    void sendFrame();
+
+private:
+    Daemon *m_daemon;
+    QLocalServer *m_server;
+    QList<SocketClient *> m_clients;
+};
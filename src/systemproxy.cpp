@@ -0,0 +1,293 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "systemproxy.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusPendingCallWatcher>
+#include <QDBusServiceWatcher>
+
+#include <systemstats/DBusInterface.h>
+
+#include "debug.h"
+
+using namespace Qt::StringLiterals;
+
+static QDBusMessage systemInstanceCall(const QString &member, const QVariantList &arguments)
+{
+    auto msg = QDBusMessage::createMethodCall(KSysGuard::SystemStats::ServiceName,
+                                              KSysGuard::SystemStats::ObjectPath,
+                                              KSysGuard::SystemStats::DBusInterface::staticInterfaceName(),
+                                              member);
+    msg.setArguments(arguments);
+    return msg;
+}
+
+SystemProxy::SystemProxy(const QDBusConnection &system, const QDBusConnection &session, QObject *parent)
+    : QDBusVirtualObject(parent)
+    , m_system(system)
+    , m_session(session)
+    , m_clientWatcher(new QDBusServiceWatcher(this))
+    , m_systemWatcher(new QDBusServiceWatcher(this))
+{
+    qDBusRegisterMetaType<KSysGuard::SensorData>();
+    qDBusRegisterMetaType<KSysGuard::SensorInfo>();
+    qDBusRegisterMetaType<KSysGuard::SensorDataList>();
+    qDBusRegisterMetaType<KSysGuard::SensorInfoMap>();
+
+    m_clientWatcher->setConnection(m_session);
+    m_clientWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    connect(m_clientWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &SystemProxy::onClientDisconnected);
+
+    m_systemWatcher->setConnection(m_system);
+    m_systemWatcher->setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+    m_systemWatcher->addWatchedService(KSysGuard::SystemStats::ServiceName);
+    connect(m_systemWatcher, &QDBusServiceWatcher::serviceUnregistered, this, &SystemProxy::onSystemInstanceStopped);
+}
+
+SystemProxy::~SystemProxy() = default;
+
+bool SystemProxy::isSystemInstanceRunning()
+{
+    auto bus = QDBusConnection::systemBus();
+    return bus.isConnected() && bus.interface()->isServiceRegistered(KSysGuard::SystemStats::ServiceName);
+}
+
+bool SystemProxy::init(Daemon::ReplaceIfRunning replaceIfRunning)
+{
+    auto interface = m_session.interface();
+    if (interface->isServiceRegistered(KSysGuard::SystemStats::ServiceName) && replaceIfRunning != Daemon::ReplaceIfRunning::Replace) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "ksystemstats is already running";
+        return false;
+    }
+
+    const QString interfaceName = KSysGuard::SystemStats::DBusInterface::staticInterfaceName();
+    const auto service = KSysGuard::SystemStats::ServiceName;
+    const auto path = KSysGuard::SystemStats::ObjectPath;
+    m_system.connect(service, path, interfaceName, u"newSensorData"_s, this, SLOT(onNewSensorData(QDBusMessage)));
+    m_system.connect(service, path, interfaceName, u"sensorMetaDataChanged"_s, this, SLOT(onSensorMetaDataChanged(QDBusMessage)));
+    m_system.connect(service, path, interfaceName, u"sensorAdded"_s, this, SLOT(relaySignal(QDBusMessage)));
+    m_system.connect(service, path, interfaceName, u"sensorRemoved"_s, this, SLOT(relaySignal(QDBusMessage)));
+
+    m_session.registerVirtualObject(path, this);
+
+    connect(interface, &QDBusConnectionInterface::serviceUnregistered, this, [](const QString &service) {
+        if (service == KSysGuard::SystemStats::ServiceName) {
+            QCoreApplication::instance()->quit();
+        }
+    });
+    auto result = interface->registerService(service, QDBusConnectionInterface::ReplaceExistingService, QDBusConnectionInterface::AllowReplacement);
+    if (result != QDBusConnectionInterface::ServiceRegistered) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Could not register name" << service;
+        return false;
+    }
+
+    qCDebug(KSYSTEMSTATS_DAEMON) << "Serving the session from the system instance";
+    return true;
+}
+
+void SystemProxy::setQuitOnLastClientDisconnect(bool quit)
+{
+    m_quitOnLastClientDisconnect = quit;
+}
+
+QString SystemProxy::introspect(const QString &path) const
+{
+    Q_UNUSED(path)
+    // Clients use the interfaces they know about, the system instance describes them
+    return QString();
+}
+
+bool SystemProxy::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.type() != QDBusMessage::MethodCallMessage) {
+        return false;
+    }
+
+    const QString member = message.member();
+    if (message.interface() == KSysGuard::SystemStats::DBusInterface::staticInterfaceName() && (member == u"subscribe" || member == u"unsubscribe")) {
+        const QStringList sensorIds = message.arguments().value(0).toStringList();
+        if (member == u"subscribe") {
+            subscribe(message.service(), sensorIds);
+        } else {
+            unsubscribe(message.service(), sensorIds);
+        }
+        connection.send(message.createReply());
+        return true;
+    }
+
+    if (message.interface() == Daemon::ControlInterface && (member == u"addThresholdRule" || member == u"startBurst")) {
+        connection.send(message.createErrorReply(QDBusError::NotSupported, u"%1 is only available on the system bus"_s.arg(member)));
+        return true;
+    }
+
+    forward(message);
+    return true;
+}
+
+void SystemProxy::forward(const QDBusMessage &message)
+{
+    auto call = QDBusMessage::createMethodCall(KSysGuard::SystemStats::ServiceName, message.path(), message.interface(), message.member());
+    // Arguments of complex types are passed on without being demarshalled
+    call.setArguments(message.arguments());
+
+    message.setDelayedReply(true);
+    auto watcher = new QDBusPendingCallWatcher(m_system.asyncCall(call), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, message](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        const QDBusMessage reply = watcher->reply();
+        if (reply.type() == QDBusMessage::ErrorMessage) {
+            m_session.send(message.createErrorReply(reply.errorName(), reply.errorMessage()));
+        } else {
+            m_session.send(message.createReply(reply.arguments()));
+        }
+    });
+}
+
+void SystemProxy::subscribe(const QString &client, const QStringList &sensorIds)
+{
+    m_clientWatcher->addWatchedService(client);
+
+    auto &subscriptions = m_subscriptions[client];
+    QStringList added;
+    KSysGuard::SensorDataList initialData;
+    for (const QString &sensorId : sensorIds) {
+        if (subscriptions.contains(sensorId)) {
+            continue;
+        }
+        subscriptions.insert(sensorId);
+        if (m_subscriberCounts[sensorId]++ == 0) {
+            added.append(sensorId);
+        } else if (auto value = m_values.constFind(sensorId); value != m_values.cend()) {
+            initialData.append(KSysGuard::SensorData(sensorId, *value));
+        }
+    }
+
+    // The system instance only sends the sensors of the session once, with their current
+    // values, which are passed on to all subscribers
+    if (!added.isEmpty()) {
+        m_system.send(systemInstanceCall(u"subscribe"_s, {added}));
+    }
+    // Later subscribers get the values from before
+    if (!initialData.isEmpty()) {
+        auto msg = QDBusMessage::createTargetedSignal(client,
+                                                      KSysGuard::SystemStats::ObjectPath,
+                                                      KSysGuard::SystemStats::DBusInterface::staticInterfaceName(),
+                                                      u"newSensorData"_s);
+        msg.setArguments({QVariant::fromValue(initialData)});
+        m_session.send(msg);
+    }
+}
+
+void SystemProxy::unsubscribe(const QString &client, const QStringList &sensorIds)
+{
+    auto subscriptions = m_subscriptions.find(client);
+    if (subscriptions == m_subscriptions.end()) {
+        return;
+    }
+
+    QStringList removed;
+    for (const QString &sensorId : sensorIds) {
+        if (!subscriptions->remove(sensorId)) {
+            continue;
+        }
+        auto count = m_subscriberCounts.find(sensorId);
+        if (--(*count) == 0) {
+            m_subscriberCounts.erase(count);
+            m_values.remove(sensorId);
+            removed.append(sensorId);
+        }
+    }
+
+    if (!removed.isEmpty()) {
+        m_system.send(systemInstanceCall(u"unsubscribe"_s, {removed}));
+    }
+}
+
+void SystemProxy::onClientDisconnected(const QString &client)
+{
+    m_clientWatcher->removeWatchedService(client);
+    unsubscribe(client, m_subscriptions.value(client).values());
+    m_subscriptions.remove(client);
+
+    if (m_subscriptions.isEmpty() && m_quitOnLastClientDisconnect) {
+        QCoreApplication::quit();
+    }
+}
+
+void SystemProxy::onSystemInstanceStopped()
+{
+    qCWarning(KSYSTEMSTATS_DAEMON) << "The system instance stopped, leaving the session to an instance of its own";
+    m_session.unregisterVirtualObject(KSysGuard::SystemStats::ObjectPath);
+    m_session.interface()->unregisterService(KSysGuard::SystemStats::ServiceName);
+    QCoreApplication::quit();
+}
+
+void SystemProxy::onNewSensorData(const QDBusMessage &message)
+{
+    const auto sensorData = qdbus_cast<KSysGuard::SensorDataList>(message.arguments().value(0));
+    for (const auto &data : sensorData) {
+        if (m_subscriberCounts.contains(data.sensorProperty)) {
+            m_values.insert(data.sensorProperty, data.payload);
+        }
+    }
+
+    KSysGuard::SensorDataList clientData;
+    for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it) {
+        clientData.clear();
+        for (const auto &data : sensorData) {
+            if (it->contains(data.sensorProperty)) {
+                clientData.append(data);
+            }
+        }
+        if (clientData.isEmpty()) {
+            continue;
+        }
+        auto msg = QDBusMessage::createTargetedSignal(it.key(),
+                                                      KSysGuard::SystemStats::ObjectPath,
+                                                      KSysGuard::SystemStats::DBusInterface::staticInterfaceName(),
+                                                      u"newSensorData"_s);
+        msg.setArguments({QVariant::fromValue(clientData)});
+        m_session.send(msg);
+    }
+}
+
+void SystemProxy::onSensorMetaDataChanged(const QDBusMessage &message)
+{
+    const auto sensors = qdbus_cast<KSysGuard::SensorInfoMap>(message.arguments().value(0));
+
+    KSysGuard::SensorInfoMap clientSensors;
+    for (auto it = m_subscriptions.cbegin(); it != m_subscriptions.cend(); ++it) {
+        clientSensors.clear();
+        for (auto sensor = sensors.cbegin(); sensor != sensors.cend(); ++sensor) {
+            if (it->contains(sensor.key())) {
+                clientSensors.insert(sensor.key(), sensor.value());
+            }
+        }
+        if (clientSensors.isEmpty()) {
+            continue;
+        }
+        auto msg = QDBusMessage::createTargetedSignal(it.key(),
+                                                      KSysGuard::SystemStats::ObjectPath,
+                                                      KSysGuard::SystemStats::DBusInterface::staticInterfaceName(),
+                                                      u"sensorMetaDataChanged"_s);
+        msg.setArguments({QVariant::fromValue(clientSensors)});
+        m_session.send(msg);
+    }
+}
+
+void SystemProxy::relaySignal(const QDBusMessage &message)
+{
+    auto msg = QDBusMessage::createSignal(KSysGuard::SystemStats::ObjectPath, message.interface(), message.member());
+    msg.setArguments(message.arguments());
+    m_session.send(msg);
+}
+
+#include "moc_systemproxy.cpp"
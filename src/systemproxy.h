@@ -0,0 +1,82 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDBusConnection>
+#include <QDBusVirtualObject>
+#include <QHash>
+#include <QSet>
+
+#include "daemon.h"
+
+class QDBusMessage;
+class QDBusServiceWatcher;
+
+/**
+ * Serves the clients of a session from the system wide instance.
+ *
+ * When ksystemstats runs as a system service, the instance started for a session
+ * only forwards. It registers the usual service on the session bus, passes method
+ * calls on to the system instance and hands out the values it receives for the
+ * union of all subscriptions to each client according to its own subscriptions.
+ * The sensors are only updated once for all users of the machine.
+ *
+ * Threshold rules and bursts are delivered to their owner, which would be the proxy,
+ * so they are only available on the system bus directly.
+ *
+ * When the system instance stops, the proxy releases the service and quits. Clients
+ * reconnect once the service is gone, which starts an instance of the session's own
+ * through D-Bus activation.
+ */
+class SystemProxy : public QDBusVirtualObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param system The bus the system instance runs on.
+     * @param session The bus to serve the clients of the session on.
+     */
+    explicit SystemProxy(const QDBusConnection &system = QDBusConnection::systemBus(),
+                         const QDBusConnection &session = QDBusConnection::sessionBus(),
+                         QObject *parent = nullptr);
+    ~SystemProxy() override;
+
+    /**
+     * Whether a system wide instance is running that the session can be served from.
+     */
+    static bool isSystemInstanceRunning();
+
+    bool init(Daemon::ReplaceIfRunning replaceIfRunning);
+    void setQuitOnLastClientDisconnect(bool quit);
+
+    QString introspect(const QString &path) const override;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+
+private Q_SLOTS:
+    void onNewSensorData(const QDBusMessage &message);
+    void onSensorMetaDataChanged(const QDBusMessage &message);
+    void relaySignal(const QDBusMessage &message);
+
+private:
+    void forward(const QDBusMessage &message);
+    void subscribe(const QString &client, const QStringList &sensorIds);
+    void unsubscribe(const QString &client, const QStringList &sensorIds);
+    void onClientDisconnected(const QString &client);
+    void onSystemInstanceStopped();
+
+    QDBusConnection m_system;
+    QDBusConnection m_session;
+    QHash<QString /*session client*/, QSet<QString>> m_subscriptions;
+    // How many session clients are subscribed to each sensor
+    QHash<QString, int> m_subscriberCounts;
+    // The last value received for each subscribed sensor, the system instance only sends
+    // the current values to the first subscriber
+    QHash<QString, QVariant> m_values;
+    QDBusServiceWatcher *m_clientWatcher;
+    QDBusServiceWatcher *m_systemWatcher;
+    bool m_quitOnLastClientDisconnect = true;
+};
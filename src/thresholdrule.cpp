@@ -0,0 +1,115 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thresholdrule.h"
+
+#include <cmath>
+
+std::optional<ThresholdRule::Comparison> ThresholdRule::parseComparison(const QString &comparison)
+{
+    if (comparison == u">") {
+        return Comparison::Greater;
+    } else if (comparison == u">=") {
+        return Comparison::GreaterOrEqual;
+    } else if (comparison == u"<") {
+        return Comparison::Less;
+    } else if (comparison == u"<=") {
+        return Comparison::LessOrEqual;
+    }
+    return std::nullopt;
+}
+
+ThresholdRule::ThresholdRule(const QString &pattern, Comparison comparison, double threshold, double hysteresis, std::chrono::milliseconds minimumDuration)
+    : m_pattern(QRegularExpression::fromWildcard(pattern, Qt::CaseSensitive))
+    , m_comparison(comparison)
+    , m_threshold(threshold)
+    , m_hysteresis(std::abs(hysteresis))
+    , m_minimumDuration(minimumDuration)
+{
+}
+
+ThresholdRule::~ThresholdRule()
+{
+    for (const auto &state : std::as_const(m_sensors)) {
+        if (state.sensor) {
+            state.sensor->unsubscribe();
+        }
+    }
+}
+
+bool ThresholdRule::matches(const QString &sensorPath) const
+{
+    return m_pattern.match(sensorPath).hasMatch();
+}
+
+void ThresholdRule::addSensor(KSysGuard::SensorProperty *sensor)
+{
+    const QString path = sensor->path();
+    if (m_sensors.contains(path)) {
+        return;
+    }
+    // Most plugins only read values of subscribed sensors
+    sensor->subscribe();
+    m_sensors.insert(path, SensorState{sensor});
+}
+
+void ThresholdRule::removeSensor(const QString &sensorPath)
+{
+    const auto state = m_sensors.take(sensorPath);
+    if (state.sensor) {
+        state.sensor->unsubscribe();
+    }
+}
+
+QList<ThresholdRule::Transition> ThresholdRule::evaluate(std::chrono::steady_clock::time_point now)
+{
+    QList<Transition> transitions;
+    for (auto it = m_sensors.begin(); it != m_sensors.end(); ++it) {
+        auto &state = it.value();
+        if (!state.sensor) {
+            continue;
+        }
+
+        bool ok = false;
+        const double value = state.sensor->value().toDouble(&ok);
+        if (!ok) {
+            continue;
+        }
+
+        if (isActive(value, state.active) == state.active) {
+            state.pendingSince.reset();
+            continue;
+        }
+
+        if (!state.pendingSince) {
+            state.pendingSince = now;
+        }
+        if (now - *state.pendingSince < m_minimumDuration) {
+            continue;
+        }
+
+        state.active = !state.active;
+        state.pendingSince.reset();
+        transitions.append(Transition{it.key(), state.active, value});
+    }
+    return transitions;
+}
+
+bool ThresholdRule::isActive(double value, bool wasActive) const
+{
+    // Once active the value needs to move back past the threshold by the hysteresis to deactivate
+    switch (m_comparison) {
+    case Comparison::Greater:
+        return value > (wasActive ? m_threshold - m_hysteresis : m_threshold);
+    case Comparison::GreaterOrEqual:
+        return value >= (wasActive ? m_threshold - m_hysteresis : m_threshold);
+    case Comparison::Less:
+        return value < (wasActive ? m_threshold + m_hysteresis : m_threshold);
+    case Comparison::LessOrEqual:
+        return value <= (wasActive ? m_threshold + m_hysteresis : m_threshold);
+    }
+    return false;
+}
@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QRegularExpression>
+
+#include <systemstats/SensorProperty.h>
+
+/**
+ * A threshold that is checked against the values of all sensors matching a pattern.
+ *
+ * Matching sensors are kept subscribed for as long as the rule exists, evaluate()
+ * then reports only the sensors that crossed the threshold since the last call.
+ */
+class ThresholdRule
+{
+public:
+    enum class Comparison {
+        Greater,
+        GreaterOrEqual,
+        Less,
+        LessOrEqual,
+    };
+
+    struct Transition {
+        QString sensorPath;
+        bool active;
+        double value;
+    };
+
+    /**
+     * Parses one of ">", ">=", "<" or "<=".
+     */
+    static std::optional<Comparison> parseComparison(const QString &comparison);
+
+    /**
+     * @param pattern A sensor path, each path segment may contain shell style wildcards.
+     * @param hysteresis How far the value needs to move back before an active rule becomes inactive again.
+     * @param minimumDuration How long a sensor needs to stay on the other side of the threshold before it is reported.
+     */
+    ThresholdRule(const QString &pattern, Comparison comparison, double threshold, double hysteresis, std::chrono::milliseconds minimumDuration);
+    ~ThresholdRule();
+    Q_DISABLE_COPY_MOVE(ThresholdRule)
+
+    bool matches(const QString &sensorPath) const;
+    void addSensor(KSysGuard::SensorProperty *sensor);
+    void removeSensor(const QString &sensorPath);
+
+    QList<Transition> evaluate(std::chrono::steady_clock::time_point now);
+
+private:
+    struct SensorState {
+        QPointer<KSysGuard::SensorProperty> sensor;
+        bool active = false;
+        // Set while the sensor is on the other side of the threshold but not yet for long enough
+        std::optional<std::chrono::steady_clock::time_point> pendingSince;
+    };
+
+    bool isActive(double value, bool wasActive) const;
+
+    QRegularExpression m_pattern;
+    Comparison m_comparison;
+    double m_threshold;
+    double m_hysteresis;
+    std::chrono::milliseconds m_minimumDuration;
+    QHash<QString, SensorState> m_sensors;
+};
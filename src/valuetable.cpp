@@ -0,0 +1,168 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "valuetable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <systemstats/SensorProperty.h>
+
+#include "debug.h"
+#include "framebuilder.h"
+
+ValueTable::ValueTable(FrameBuilder *frameBuilder, const QStringList &patterns, uint capacity, QObject *parent)
+    : QObject(parent)
+    , m_frameBuilder(frameBuilder)
+    , m_capacity(capacity)
+{
+    for (const QString &pattern : patterns) {
+        m_patterns.append(QRegularExpression::fromWildcard(pattern, Qt::CaseSensitive));
+    }
+}
+
+ValueTable::~ValueTable()
+{
+    for (const auto &slot : std::as_const(m_tableSlots)) {
+        if (slot.sensor) {
+            disconnect(slot.destroyed);
+            m_frameBuilder->removeSensor(slot.sensor);
+            slot.sensor->unsubscribe();
+        }
+    }
+    if (m_header) {
+        munmap(m_header, ksystemstats_valuetable_size(m_capacity));
+        shm_unlink(m_name.constData());
+    }
+}
+
+bool ValueTable::open(const QString &name)
+{
+    m_name = name.toLocal8Bit();
+    shm_unlink(m_name.constData());
+    // Readable by everyone, only the daemon writes
+    const int fd = shm_open(m_name.constData(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Could not create shared memory" << name << strerror(errno);
+        return false;
+    }
+
+    const auto size = ksystemstats_valuetable_size(m_capacity);
+    void *memory = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (memory == MAP_FAILED) {
+        qCWarning(KSYSTEMSTATS_DAEMON) << "Could not map shared memory" << name << strerror(errno);
+        shm_unlink(m_name.constData());
+        return false;
+    }
+
+    // A new object is zero filled, so every slot starts out invalid
+    m_header = static_cast<ksystemstats_valuetable_header *>(memory);
+    m_slots = reinterpret_cast<ksystemstats_valuetable_slot *>(m_header + 1);
+    m_directory = reinterpret_cast<ksystemstats_valuetable_entry *>(m_slots + m_capacity);
+    m_header->capacity = m_capacity;
+    m_header->version = KSYSTEMSTATS_VALUETABLE_VERSION;
+    std::atomic_ref(m_header->magic).store(KSYSTEMSTATS_VALUETABLE_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void ValueTable::addSensor(KSysGuard::SensorProperty *sensor)
+{
+    if (!m_header) {
+        return;
+    }
+
+    const QString path = sensor->path();
+    const bool matches = std::any_of(m_patterns.cbegin(), m_patterns.cend(), [&path](const QRegularExpression &pattern) {
+        return pattern.match(path).hasMatch();
+    });
+    if (!matches) {
+        return;
+    }
+
+    int slot = m_slotsByPath.value(path, -1);
+    if (slot >= 0 && m_tableSlots[slot].sensor) {
+        return;
+    }
+    if (slot < 0) {
+        const QByteArray encodedPath = path.toUtf8();
+        if (encodedPath.size() >= KSYSTEMSTATS_VALUETABLE_PATH_SIZE) {
+            qCWarning(KSYSTEMSTATS_DAEMON) << "Path of sensor" << path << "is too long for the value table";
+            return;
+        }
+        if (m_tableSlots.size() == qsizetype(m_capacity)) {
+            qCWarning(KSYSTEMSTATS_DAEMON) << "Value table is full, not publishing" << path;
+            return;
+        }
+        slot = m_tableSlots.size();
+        m_tableSlots.append(Slot{});
+        m_slotsByPath.insert(path, slot);
+        memcpy(m_directory[slot].path, encodedPath.constData(), encodedPath.size() + 1);
+        // Readers only look at the directory entry once it is counted
+        std::atomic_ref(m_header->slot_count).store(slot + 1, std::memory_order_release);
+    }
+
+    auto &tableSlot = m_tableSlots[slot];
+    tableSlot.sensor = sensor;
+    tableSlot.index = m_frameBuilder->addSensor(sensor);
+    // The frame builder releases the index of destroyed sensors by itself
+    tableSlot.destroyed = connect(sensor, &QObject::destroyed, this, [this, slot]() {
+        m_tableSlots[slot] = Slot{};
+        writeSlot(slot, false, 0.0, m_frameBuilder->timestamp());
+    });
+    sensor->subscribe();
+}
+
+void ValueTable::write()
+{
+    if (!m_header) {
+        return;
+    }
+
+    const qint64 timestamp = m_frameBuilder->timestamp();
+    for (int i = 0; i < m_tableSlots.size(); ++i) {
+        const auto &slot = m_tableSlots[i];
+        if (!slot.sensor) {
+            continue;
+        }
+        const bool valid = m_frameBuilder->hasValue(slot.index);
+        writeSlot(i, valid, valid ? m_frameBuilder->toDouble(slot.index) : 0.0, timestamp);
+    }
+
+    std::atomic_ref(m_header->timestamp).store(timestamp, std::memory_order_relaxed);
+    std::atomic_ref(m_header->generation).store(m_frameBuilder->generation(), std::memory_order_release);
+}
+
+const ksystemstats_valuetable_header *ValueTable::header() const
+{
+    return m_header;
+}
+
+void ValueTable::writeSlot(int slot, bool valid, double value, qint64 timestamp)
+{
+    auto &target = m_slots[slot];
+    std::atomic_ref sequence(target.sequence);
+    const uint32_t before = sequence.load(std::memory_order_relaxed);
+    // Odd while writing, readers retry until it is even and did not change
+    sequence.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::atomic_ref(target.valid).store(valid, std::memory_order_relaxed);
+    std::atomic_ref(target.value).store(value, std::memory_order_relaxed);
+    std::atomic_ref(target.timestamp).store(timestamp, std::memory_order_relaxed);
+    sequence.store(before + 2, std::memory_order_release);
+}
+
+#include "moc_valuetable.cpp"
@@ -0,0 +1,79 @@
+/*
+    SPDX-FileCopyrightText: 2026 KSystemStats Contributors
+
+    SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRegularExpression>
+
+#include "ksystemstats_valuetable.h"
+
+namespace KSysGuard
+{
+    class SensorProperty;
+}
+
+class FrameBuilder;
+
+/**
+ * Publishes the latest values of selected sensors in shared memory.
+ *
+ * Local consumers that only want the current value of a few sensors map the
+ * table and poll it, see ksystemstats_valuetable.h for the layout. The sensors
+ * stay subscribed while they are published and are written once per frame.
+ * Only numeric values are published.
+ */
+class ValueTable : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr uint DefaultCapacity = 256;
+
+    /**
+     * @param patterns Sensor paths, each path segment may contain shell style wildcards.
+     */
+    ValueTable(FrameBuilder *frameBuilder, const QStringList &patterns, uint capacity, QObject *parent = nullptr);
+    ~ValueTable() override;
+
+    /**
+     * Creates the shared memory object @p name, replacing an existing one.
+     */
+    bool open(const QString &name);
+
+    /**
+     * Publishes @p sensor if it matches any of the patterns.
+     */
+    void addSensor(KSysGuard::SensorProperty *sensor);
+
+    /**
+     * Writes the values of the frame last built.
+     */
+    void write();
+
+    const ksystemstats_valuetable_header *header() const;
+
+private:
+    struct Slot {
+        KSysGuard::SensorProperty *sensor = nullptr;
+        int index = -1;
+        QMetaObject::Connection destroyed;
+    };
+
+    void writeSlot(int slot, bool valid, double value, qint64 timestamp);
+
+    FrameBuilder *m_frameBuilder;
+    QList<QRegularExpression> m_patterns;
+    uint m_capacity;
+    QByteArray m_name;
+    ksystemstats_valuetable_header *m_header = nullptr;
+    ksystemstats_valuetable_slot *m_slots = nullptr;
+    ksystemstats_valuetable_entry *m_directory = nullptr;
+    QList<Slot> m_tableSlots;
+    // Slots keep their path, so a sensor that is added again gets its old slot
+    QHash<QString, int> m_slotsByPath;
+};